@@ -0,0 +1,580 @@
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "my_scanf.h"
+
+/* --- UTILITIES --- */
+
+#define BENCH_FILE "bench_input.tmp"
+
+// Helper: Redirects stdin to the generated benchmark input.
+static void open_input(void) {
+    freopen(BENCH_FILE, "r", stdin);
+}
+
+// Helper: Seconds elapsed since 'start'.
+static double elapsed(clock_t start) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+// Helper: Prints one result line (time per item and throughput).
+static void report(const char *name, long items, long bytes, double secs) {
+    if (secs <= 0) secs = 1e-9;
+    printf("%-28s %9ld items  %8.1f ns/item  %8.1f MB/s\n",
+           name, items, secs * 1e9 / items, bytes / secs / 1e6);
+}
+
+/* =========================================================================
+ * INTEGER BENCHMARKS (radix engine)
+ * ========================================================================= */
+
+// Writes 'count' numbers in the given printf format, returns bytes written.
+// The value is passed twice so a format may print it as two halves.
+static long write_numbers(const char *fmt, long count) {
+    FILE *fp = fopen(BENCH_FILE, "w");
+    long bytes = 0;
+    unsigned long long x = 88172645463325252ULL;
+
+    if (!fp) return 0;
+    for (long i = 0; i < count; i++) {
+        // xorshift: cheap, reproducible spread of magnitudes
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        unsigned long long v = x >> (x & 31);
+        bytes += fprintf(fp, fmt, v, v % 10000000000000000000ULL);
+    }
+    fclose(fp);
+    return bytes;
+}
+
+static void bench_integers(long count) {
+    unsigned long long v;
+    long long sv;
+    long bytes;
+    clock_t start;
+
+    bytes = write_numbers("%llu\n", count);
+    open_input();
+    start = clock();
+    for (long i = 0; i < count; i++) my_scanf("%lld", &sv);
+    report("%lld (decimal)", count, bytes, elapsed(start));
+
+    open_input();
+    start = clock();
+    for (long i = 0; i < count; i++) my_scanf("%llu", &v);
+    report("%llu (decimal)", count, bytes, elapsed(start));
+
+    bytes = write_numbers("%llx\n", count);
+    open_input();
+    start = clock();
+    for (long i = 0; i < count; i++) my_scanf("%llx", &v);
+    report("%llx (hex)", count, bytes, elapsed(start));
+
+    bytes = write_numbers("%llo\n", count);
+    open_input();
+    start = clock();
+    for (long i = 0; i < count; i++) my_scanf("%llo", &v);
+    report("%llo (octal)", count, bytes, elapsed(start));
+
+    bytes = write_numbers("0x%llx\n", count);
+    open_input();
+    start = clock();
+    for (long i = 0; i < count; i++) my_scanf("%lli", &sv);
+    report("%lli (auto, 0x prefix)", count, bytes, elapsed(start));
+#ifdef __SIZEOF_INT128__
+    {
+        unsigned __int128 w;
+        bytes = write_numbers("%llu%019llu\n", count);
+        open_input();
+        start = clock();
+        for (long i = 0; i < count; i++) my_scanf("%I128u", &w);
+        report("%I128u (decimal, 128-bit)", count, bytes, elapsed(start));
+    }
+#endif
+}
+
+/* =========================================================================
+ * FLOAT BENCHMARKS (decimal vs hex-float)
+ * ========================================================================= */
+
+// Writes 'count' doubles in the given printf format, returns bytes written.
+static long write_doubles(const char *fmt, long count) {
+    FILE *fp = fopen(BENCH_FILE, "w");
+    long bytes = 0;
+    unsigned long long x = 88172645463325252ULL;
+
+    if (!fp) return 0;
+    for (long i = 0; i < count; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        bytes += fprintf(fp, fmt, (double)(x >> 11) / (double)((x & 0xFFFFF) | 1));
+    }
+    fclose(fp);
+    return bytes;
+}
+
+static void bench_floats(long count) {
+    double d;
+    long bytes;
+    clock_t start;
+
+    bytes = write_doubles("%.17g\n", count);
+    open_input();
+    start = clock();
+    for (long i = 0; i < count; i++) my_scanf("%lf", &d);
+    report("%lf (decimal)", count, bytes, elapsed(start));
+
+    bytes = write_doubles("%a\n", count);
+    open_input();
+    start = clock();
+    for (long i = 0; i < count; i++) my_scanf("%la", &d);
+    report("%la (hex-float, exact)", count, bytes, elapsed(start));
+}
+
+/* =========================================================================
+ * BATCH BENCHMARKS (my_scanf loop vs my_scanf_batch, memory source)
+ * ========================================================================= */
+
+// Builds 'count' "<int> <double>\n" records in memory; *len gets the size.
+static char *make_records(long count, size_t *len) {
+    char *text = malloc((size_t)count * 40 + 1);
+    unsigned long long x = 88172645463325252ULL;
+    size_t n = 0;
+
+    if (text == NULL) return NULL;
+    for (long i = 0; i < count; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        n += sprintf(text + n, "%d %.6f\n", (int)(x % 1000000), (double)(x >> 40) / 1024.0);
+    }
+    *len = n;
+    return text;
+}
+
+static void bench_batch(long count) {
+    size_t len, fail;
+    char *text = make_records(count, &len);
+    int *ids = malloc(count * sizeof(int));
+    double *vals = malloc(count * sizeof(double));
+    ScanSource src;
+    clock_t start;
+
+    if (text && ids && vals) {
+        my_scanf_source_memory(&src, text, len);
+        my_scanf_set_source(&src);
+        start = clock();
+        for (long i = 0; i < count; i++) my_scanf("%d %lf", &ids[i], &vals[i]);
+        report("my_scanf loop (memory)", count, (long)len, elapsed(start));
+        my_scanf_set_source(NULL);
+
+        void *cols[] = {ids, vals};
+        size_t strides[] = {sizeof(int), sizeof(double)};
+        my_scanf_source_memory(&src, text, len);
+        start = clock();
+        my_scanf_batch("%d %lf", &src, (size_t)count, cols, strides, &fail);
+        report("my_scanf_batch (memory)", count, (long)len, elapsed(start));
+
+        start = clock();
+        my_scanf_indexed("%d %lf", text, len, (size_t)count, cols, strides, &fail);
+        report("my_scanf_indexed (memory)", count, (long)len, elapsed(start));
+
+        my_scanf_source_memory(&src, text, len);
+        start = clock();
+        my_scanf_validate("%d %lf", &src, &fail);
+        report("my_scanf_validate (memory)", count, (long)len, elapsed(start));
+
+        typedef struct { int id; double val; } Rec;
+        const ScanField fields[] = {
+            {"d", 0, offsetof(Rec, id),  sizeof(int)},
+            {"f", 0, offsetof(Rec, val), sizeof(double)},
+        };
+        Rec *recs = malloc(count * sizeof(Rec));
+        if (recs) {
+            my_scanf_source_memory(&src, text, len);
+            start = clock();
+            my_scanf_records(fields, 2, &src, recs, sizeof(Rec), (size_t)count, &fail);
+            report("my_scanf_records (memory)", count, (long)len, elapsed(start));
+            free(recs);
+        }
+    }
+    free(text);
+    free(ids);
+    free(vals);
+}
+
+/* =========================================================================
+ * BASE64 BENCHMARKS (%B vs %s plus a separate decode pass)
+ * ========================================================================= */
+
+// Helper: Plain table decoder for the "%s, then decode" baseline.
+static size_t decode_base64_text(const char *s, unsigned char *out) {
+    static signed char value[256];
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t n = 0;
+    unsigned acc = 0;
+    int bits = 0;
+
+    if (value['B'] == 0) {
+        memset(value, -1, sizeof(value));
+        for (int i = 0; i < 64; i++) value[(unsigned char)alphabet[i]] = (signed char)i;
+    }
+    for (; value[(unsigned char)*s] >= 0; s++) {
+        acc = (acc << 6) | (unsigned)value[(unsigned char)*s];
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out[n++] = (unsigned char)(acc >> bits);
+        }
+    }
+    return n;
+}
+
+static void bench_base64(long count) {
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char *text = malloc((size_t)count * 130 + 1);
+    unsigned long long x = 88172645463325252ULL;
+    size_t len = 0;
+    unsigned char payload[96];
+    char field[129];
+    size_t n;
+    ScanSource src;
+    clock_t start;
+
+    if (text == NULL) return;
+    // 96-byte payloads: 128 base64 characters per line
+    for (long i = 0; i < count; i++) {
+        for (int k = 0; k < 128; k++) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            text[len++] = alphabet[x & 63];
+        }
+        text[len++] = '\n';
+    }
+    text[len] = '\0';
+
+    my_scanf_source_memory(&src, text, len);
+    my_scanf_set_source(&src);
+    start = clock();
+    for (long i = 0; i < count; i++) my_scanf("%B", payload, &n);
+    report("base64 %B (memory)", count, (long)len, elapsed(start));
+
+    my_scanf_source_memory(&src, text, len);
+    start = clock();
+    for (long i = 0; i < count; i++) {
+        my_scanf("%128s", field);
+        n = decode_base64_text(field, payload);
+    }
+    report("base64 %s + decode (memory)", count, (long)len, elapsed(start));
+    my_scanf_set_source(NULL);
+    free(text);
+}
+
+/* =========================================================================
+ * LAZY BENCHMARKS (filter on one field, 10% of rows kept)
+ * ========================================================================= */
+
+static void bench_scanset(long count) {
+    char *text = malloc((size_t)count * 64 + 1);
+    size_t len = 0;
+    char key[64], val[64];
+    ScanSource src;
+    clock_t start;
+
+    if (text == NULL) return;
+    for (long i = 0; i < count; i++) {
+        len += sprintf(text + len, "customer_%08ld_account,region-%ld status active\n", i, i % 97);
+    }
+
+    my_scanf_source_memory(&src, text, len);
+    my_scanf_set_source(&src);
+    start = clock();
+    for (long i = 0; i < count; i++) my_scanf("%63[^,],%63[^\n] ", key, val);
+    report("scanset key,value (memory)", count, (long)len, elapsed(start));
+    my_scanf_set_source(NULL);
+    free(text);
+}
+
+static void bench_lazy(long count) {
+    char *text = malloc((size_t)count * 48 + 1);
+    unsigned long long x = 88172645463325252ULL;
+    size_t len = 0;
+    long kept = 0;
+    int id;
+    double val;
+    Date date;
+    ScanSource src;
+    LazyRecord r;
+    clock_t start;
+
+    if (text == NULL) return;
+    text[0] = '\0';
+    for (long i = 0; i < count; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        len += sprintf(text + len, "%d %.6f %02d/%02d/%d\n", (int)(x % 1000000),
+                       (double)(x >> 40) / 1024.0, 1 + (int)(x % 28), 1 + (int)(x % 12), 2000 + (int)(x % 25));
+    }
+
+    // Eager: every field of every row is converted
+    my_scanf_source_memory(&src, text, len);
+    my_scanf_set_source(&src);
+    start = clock();
+    for (long i = 0; i < count; i++) {
+        my_scanf("%d %lf %D", &id, &val, &date);
+        kept += (id % 10 == 0);
+    }
+    report("eager my_scanf + filter", count, (long)len, elapsed(start));
+    my_scanf_set_source(NULL);
+
+    // Lazy: only the id of every row; the rest for kept rows
+    if (my_scanf_lazy_open(&r, "%d %lf %D", text, len)) {
+        start = clock();
+        while (my_scanf_lazy_next(&r) == 1) {
+            if (my_scanf_lazy_get(&r, 0, &id) && id % 10 == 0) {
+                my_scanf_lazy_get(&r, 1, &val);
+                my_scanf_lazy_get(&r, 2, &date);
+            }
+        }
+        report("lazy records + filter", count, (long)len, elapsed(start));
+        my_scanf_lazy_close(&r);
+    }
+    free(text);
+}
+
+/* =========================================================================
+ * PARALLEL BENCHMARKS (my_scanf_parallel scaling, wall clock)
+ * ========================================================================= */
+
+// Helper: Monotonic wall-clock seconds (clock() sums CPU time over threads).
+static double wall_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench_parallel(long count) {
+    static const int workers[] = {1, 2, 4, 8, 16};
+    long records = count * 10;
+    size_t len, fail;
+    char *text = make_records(records, &len);
+    int *ids = malloc(records * sizeof(int));
+    double *vals = malloc(records * sizeof(double));
+    void *cols[] = {ids, vals};
+    size_t strides[] = {sizeof(int), sizeof(double)};
+    double base = 0;
+    char name[40];
+
+    if (text && ids && vals) {
+        for (int w = 0; w < 5; w++) {
+            double start = wall_seconds();
+            my_scanf_parallel("%d %lf", text, len, (size_t)records, cols, strides, workers[w], &fail);
+            double secs = wall_seconds() - start;
+            if (w == 0) base = secs;
+            snprintf(name, sizeof name, "parallel x%d (%.2fx)", workers[w], base / secs);
+            report(name, records, (long)len, secs);
+        }
+
+        // Load balance of the last run: busy time per worker
+        ParallelStats ps;
+        my_scanf_get_parallel_stats(&ps);
+        printf("  %zu units over %d workers, busy ms:", ps.units, ps.workers);
+        for (int i = 0; i < ps.workers; i++) {
+            printf(" %.1f%s", ps.busy_seconds[i] * 1e3, ps.steals[i] ? "*" : "");
+        }
+        printf("  (* = stole work)\n");
+    }
+    free(text);
+    free(ids);
+    free(vals);
+}
+
+/* =========================================================================
+ * BIGNUM BENCHMARKS (%Z)
+ * ========================================================================= */
+
+// Writes 'count' random decimal numbers of 'digits' digits each.
+static long write_bignums(int digits, long count) {
+    FILE *fp = fopen(BENCH_FILE, "w");
+    unsigned long long x = 2463534242ULL;
+
+    if (!fp) return 0;
+    for (long i = 0; i < count; i++) {
+        for (int d = 0; d < digits; d++) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            fputc('0' + (int)((d == 0) ? 1 + x % 9 : x % 10), fp);
+        }
+        fputc('\n', fp);
+    }
+    fclose(fp);
+    return (long)(digits + 1) * count;
+}
+
+static void bench_bignums(long count) {
+    static const int sizes[] = {100, 1000, 10000};
+    uint64_t *limbs = malloc(600 * sizeof(uint64_t));  // 10^10000 < 2^(64*520)
+    BigInt z = {limbs, 600, 0, 0};
+    char name[32];
+
+    if (limbs == NULL) return;
+    for (int s = 0; s < 3; s++) {
+        // Keep the bytes per run roughly constant across sizes
+        long n = count * 10 / sizes[s];
+        if (n < 10) n = 10;
+
+        long bytes = write_bignums(sizes[s], n);
+        open_input();
+        clock_t start = clock();
+        for (long i = 0; i < n; i++) my_scanf("%Z", &z);
+        snprintf(name, sizeof name, "%%Z (%d digits)", sizes[s]);
+        report(name, n, bytes, elapsed(start));
+    }
+    free(limbs);
+}
+
+/* =========================================================================
+ * STREAMING SOURCE BENCHMARKS (stdio vs pipelined reads of a pipe)
+ * ========================================================================= */
+
+static void bench_pipelined(long count) {
+    size_t len, fail;
+    char *text = make_records(count, &len);
+    int *ids = malloc((size_t)count * sizeof(int));
+    double *vals = malloc((size_t)count * sizeof(double));
+    void *cols[2];
+    size_t strides[] = {sizeof(int), sizeof(double)};
+    FILE *fp;
+    ScanSource src;
+    double start;
+
+    if (text == NULL || ids == NULL || vals == NULL) goto done;
+    cols[0] = ids;
+    cols[1] = vals;
+    fp = fopen(BENCH_FILE, "w");
+    if (fp == NULL) goto done;
+    fwrite(text, 1, len, fp);
+    fclose(fp);
+
+    // Both read the file through `cat`, so the parser sees a real pipe
+    fp = popen("cat " BENCH_FILE, "r");
+    if (fp != NULL) {
+        my_scanf_source_file(&src, fp);
+        start = wall_seconds();
+        my_scanf_batch("%d %lf", &src, (size_t)count, cols, strides, &fail);
+        report("pipe, stdio getc", count, (long)len, wall_seconds() - start);
+        pclose(fp);
+    }
+
+    fp = popen("cat " BENCH_FILE, "r");
+    if (fp != NULL) {
+        if (my_scanf_source_pipelined(&src, fileno(fp), 0, 4)) {
+            start = wall_seconds();
+            my_scanf_batch("%d %lf", &src, (size_t)count, cols, strides, &fail);
+            report("pipe, pipelined reader", count, (long)len, wall_seconds() - start);
+            my_scanf_source_close(&src);
+        }
+        pclose(fp);
+    }
+
+    fp = popen("cat " BENCH_FILE, "r");
+    if (fp != NULL) {
+        if (my_scanf_source_fd(&src, fileno(fp), 0)) {
+            start = wall_seconds();
+            my_scanf_batch("%d %lf", &src, (size_t)count, cols, strides, &fail);
+            report("pipe, large-pipe read()", count, (long)len, wall_seconds() - start);
+            my_scanf_source_close(&src);
+        }
+        pclose(fp);
+    }
+
+done:
+    free(text);
+    free(ids);
+    free(vals);
+}
+
+// Helper: Drops the file's pages from the page cache (no root needed)
+static void evict_input(void) {
+    int fd = open(BENCH_FILE, O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+static void bench_uring(long count) {
+    long records = count * 10;
+    size_t len, fail;
+    char *text = make_records(records, &len);
+    int *ids = malloc((size_t)records * sizeof(int));
+    double *vals = malloc((size_t)records * sizeof(double));
+    void *cols[2];
+    size_t strides[] = {sizeof(int), sizeof(double)};
+    FILE *fp;
+    ScanSource src;
+    double start;
+
+    if (text == NULL || ids == NULL || vals == NULL) goto done;
+    cols[0] = ids;
+    cols[1] = vals;
+    fp = fopen(BENCH_FILE, "w");
+    if (fp == NULL) goto done;
+    fwrite(text, 1, len, fp);
+    fclose(fp);
+
+    // Cold cache: every run starts with the file evicted
+    evict_input();
+    fp = fopen(BENCH_FILE, "r");
+    if (fp != NULL) {
+        my_scanf_source_file(&src, fp);
+        start = wall_seconds();
+        my_scanf_batch("%d %lf", &src, (size_t)records, cols, strides, &fail);
+        report("cold file, stdio read()", records, (long)len, wall_seconds() - start);
+        fclose(fp);
+    }
+
+    evict_input();
+    fp = fopen(BENCH_FILE, "r");
+    if (fp != NULL) {
+        int mode = my_scanf_source_uring(&src, fileno(fp), 0, 8);
+        if (mode) {
+            start = wall_seconds();
+            my_scanf_batch("%d %lf", &src, (size_t)records, cols, strides, &fail);
+            report(mode == 2 ? "cold file, io_uring" : "cold file, pread",
+                   records, (long)len, wall_seconds() - start);
+            my_scanf_source_close(&src);
+        }
+        fclose(fp);
+    }
+
+done:
+    free(text);
+    free(ids);
+    free(vals);
+}
+
+/* =========================================================================
+ * MAIN RUNNER
+ * ========================================================================= */
+
+int main(int argc, char **argv) {
+    long count = (argc > 1) ? atol(argv[1]) : 200000;
+
+    printf("========================================\n");
+    printf("MY_SCANF BENCHMARKS (%ld items per run)\n", count);
+    printf("========================================\n");
+
+    bench_integers(count);
+    bench_floats(count);
+    bench_batch(count);
+    bench_scanset(count);
+    bench_base64(count);
+    bench_lazy(count);
+    bench_parallel(count);
+    bench_pipelined(count);
+    bench_uring(count);
+    bench_bignums(count);
+
+    remove(BENCH_FILE);
+    return 0;
+}
@@ -4,6 +4,8 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <stddef.h>
 
 // Definition of the structure for the color
 typedef struct {
@@ -18,7 +20,177 @@ typedef struct {
     int year;
 } Date;
 
+// Destination for %Z: arbitrary-precision integer in caller-owned storage.
+// limbs[0] is the least significant 64-bit word.
+typedef struct {
+    uint64_t *limbs;  // Caller-provided array of 'capacity' limbs
+    size_t capacity;  // Number of limbs available in 'limbs'
+    size_t size;      // Out: limbs in use (0 for the value 0)
+    int negative;     // Out: 1 if the value is negative
+} BigInt;
+
+// Runtime counters reported by my_scanf_get_stats()
+typedef struct {
+    unsigned long long date_cache_hits;   // %D values served from the cache
+    unsigned long long date_cache_misses; // %D values decoded while the cache was on
+    unsigned long long index_fast_records; // my_scanf_indexed(): records parsed from the index
+    unsigned long long index_slow_records; // my_scanf_indexed(): records re-run by the interpreter
+} ScanStats;
+
+// Where my_scanf() reads from: a stdio stream, a memory buffer, or blocks
+// delivered by a refill hook. Set up with my_scanf_source_file() /
+// my_scanf_source_memory() / my_scanf_source_pipelined() /
+// my_scanf_source_uring() / my_scanf_source_fd().
+typedef struct ScanSource {
+    FILE *fp;          // Stream source, or NULL for a memory source
+    const char *data;  // Memory source bytes (not owned), or the current block
+    size_t len;        // Bytes at 'data'
+    size_t pos;        // Absolute offset of the cursor
+    int eof;           // Memory source: a read hit the end
+    size_t base;       // Absolute offset of data[0] (0 for a plain buffer)
+    int (*refill)(struct ScanSource *src);  // Loads the next block; 0 at end
+    void *ctx;         // State of the refill hook
+} ScanSource;
+
+// One field of a record layout for my_scanf_records(). The length modifier
+// follows from 'size' (e.g. "d" with size 8 reads a 64-bit integer; "s"
+// with size 16 reads at most 15 chars).
+typedef struct {
+    const char *spec;  // Conversion without '%' or modifier: "d", "f", "s", "[^,]", "D", ...
+    int width;         // Max field width, or 0 for none / the field size
+    size_t offset;     // offsetof(record, field)
+    size_t size;       // sizeof(field)
+} ScanField;
+
+// One field of the current record of a LazyRecord: where its text is,
+// and its value once my_scanf_lazy_get() has converted it
+#define MY_SCANF_LAZY_FIELDS 32
+typedef struct {
+    size_t offset;  // Start of the field's text in the buffer
+    size_t length;  // Length of the field's text
+    char spec;      // Conversion letter ('d', 'f', 'D', ...)
+    int state;      // 0 not converted yet, 1 converted, -1 does not convert
+    union {
+        long double align;
+        unsigned char bytes[32];
+    } value;        // Cached value (internal)
+} LazyField;
+
+// Lazy record reader over a memory buffer (my_scanf_lazy_*)
+typedef struct {
+    const char *data;
+    size_t len;
+    size_t pos;           // Offset of the next record
+    size_t record_start;  // Offset of the current record
+    int nfields;          // Fields in the current record
+    LazyField fields[MY_SCANF_LAZY_FIELDS];
+    void *plan;           // Compiled format (internal)
+} LazyRecord;
+
+// Per-worker load report of the last my_scanf_parallel() call
+#define MY_SCANF_MAX_WORKERS 128
+typedef struct {
+    int workers;                                     // Threads used
+    size_t units;                                    // Work units the input was cut into
+    double busy_seconds[MY_SCANF_MAX_WORKERS];       // Time each worker spent on units
+    unsigned long units_done[MY_SCANF_MAX_WORKERS];  // Units processed (both passes)
+    unsigned long steals[MY_SCANF_MAX_WORKERS];      // Units taken from other workers
+} ParallelStats;
+
 // This is the "signature" of your function
 int my_scanf(const char *format, ...);
 
+// Bulk-parses whitespace-separated "#RRGGBB" / "#RRGGBBAA" tokens from a
+// memory buffer into 'out' (3 or 4 bytes per color). Returns the number of
+// colors stored; *fail_offset gets the offset of the first malformed token
+// (or where parsing stopped).
+size_t my_scanf_colors(const char *src, size_t len, uint8_t *out,
+                       size_t max_colors, int channels, size_t *fail_offset);
+
+// Applies 'format' once per record, storing conversion i of record r at
+// columns[i] + r * strides[i]. Stops at end of input, at the first failing
+// record, or after n_max records; returns the number of records stored.
+// *fail_offset gets the failing record's offset (or where parsing stopped).
+size_t my_scanf_batch(const char *format, ScanSource *src, size_t n_max,
+                      void *const columns[], const size_t strides[],
+                      size_t *fail_offset);
+
+// Checks records of 'format' over 'src' (NULL: the active source) without
+// storing anything. Returns how many match; *fail_offset gets the first
+// record that does not (or the end of input).
+size_t my_scanf_validate(const char *format, ScanSource *src, size_t *fail_offset);
+
+// Fills up to n_max structs of 'record_size' bytes at 'records', one per
+// whitespace-separated record described by 'fields'. Same stop rules and
+// *fail_offset as my_scanf_batch(); returns 0 for an invalid schema.
+size_t my_scanf_records(const ScanField *fields, size_t nfields, ScanSource *src,
+                        void *records, size_t record_size, size_t n_max,
+                        size_t *fail_offset);
+
+// my_scanf_batch() over 'len' bytes of memory, in two stages: a vectorized
+// pass indexes the token boundaries, then conversions run on the spans.
+// Same results, stop rules and *fail_offset as my_scanf_batch().
+size_t my_scanf_indexed(const char *format, const char *data, size_t len,
+                        size_t n_max, void *const columns[], const size_t strides[],
+                        size_t *fail_offset);
+
+// Lazy records: my_scanf_lazy_next() locates the fields of the next record
+// (1 = record, 0 = end, -1 = no match); my_scanf_lazy_get() converts field
+// i into 'out' on first use and caches it. Fields split at whitespace and
+// the format's literals; a format with literals cannot hold %s, which
+// my_scanf() runs up to whitespace (my_scanf_lazy_open() returns 0).
+int my_scanf_lazy_open(LazyRecord *r, const char *format, const char *data, size_t len);
+int my_scanf_lazy_next(LazyRecord *r);
+int my_scanf_lazy_get(LazyRecord *r, int field, void *out);
+void my_scanf_lazy_close(LazyRecord *r);
+
+// my_scanf_batch() over 'len' bytes of memory (e.g. an mmap'd file) on
+// 'threads' workers (<= 0: all CPUs). One record per line; rows come out
+// in input order. Workers use the caller's %D cache setting, and their
+// counters are added to the caller's my_scanf_get_stats().
+size_t my_scanf_parallel(const char *format, const char *data, size_t len,
+                         size_t n_max, void *const columns[], const size_t strides[],
+                         int threads, size_t *fail_offset);
+
+// Copies the calling thread's last my_scanf_parallel() report into 'out'
+void my_scanf_get_parallel_stats(ParallelStats *out);
+
+// Prepares a source over a stream / over 'len' bytes of memory
+void my_scanf_source_file(ScanSource *src, FILE *fp);
+void my_scanf_source_memory(ScanSource *src, const char *data, size_t len);
+
+// Prepares a source that reads 'fd' on a background thread into 'nblocks'
+// buffers of 'block_size' bytes (0: 1 MiB), so I/O overlaps parsing.
+// Returns 0 on failure. my_scanf_source_close() stops it and frees them.
+int my_scanf_source_pipelined(ScanSource *src, int fd, size_t block_size, int nblocks);
+
+// Prepares a source that reads the seekable file 'fd' from its current
+// offset in 'block_size' blocks (0: 1 MiB), keeping 'depth' reads queued
+// ahead through io_uring. Returns 2 with io_uring, 1 with the pread()
+// fallback, 0 on failure. Release with my_scanf_source_close().
+int my_scanf_source_uring(ScanSource *src, int fd, size_t block_size, int depth);
+
+// Prepares a source that read()s 'fd' (e.g. STDIN_FILENO) straight into
+// one 'block_size' block (0: 4 MiB); a pipe is enlarged with F_SETPIPE_SZ
+// where permitted. Returns 0 on failure. Release with my_scanf_source_close().
+int my_scanf_source_fd(ScanSource *src, int fd, size_t block_size);
+
+// Stops a pipelined / readahead / descriptor source and frees its buffers
+void my_scanf_source_close(ScanSource *src);
+
+// Makes 'src' the input of my_scanf(); NULL switches back to stdin
+void my_scanf_set_source(ScanSource *src);
+
+// Absolute byte offset of the active source's cursor
+size_t my_scanf_tell(void);
+
+// Enables (1) or disables (0) the %D last-value cache (calling thread)
+void my_scanf_date_cache(int enable);
+
+// Copies the calling thread's counters into 'out'
+void my_scanf_get_stats(ScanStats *out);
+
+// Sets every counter back to zero
+void my_scanf_reset_stats(void);
+
 #endif
\ No newline at end of file
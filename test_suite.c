@@ -1,6 +1,11 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
 #include "my_scanf.h"
 
 static int tests_run = 0;
@@ -263,6 +268,149 @@ void test_modifiers_hd(void) {
     ASSERT_EQ(32000, h, "MOD04_Short_Val");
 }
 
+/* =========================================================================
+ * RADIX ENGINE TESTS (%i, %u, %o + long digit runs)
+ * ========================================================================= */
+
+void test_i_auto_bases(void) {
+    // Test: %i picks the base from the prefix.
+    int a = 0, b = 0, c = 0, d = 0;
+    prepare_input("42 0x1F 017 0b101");
+    ASSERT_EQ(4, my_scanf("%i %i %i %i", &a, &b, &c, &d), "I01_Ret");
+    ASSERT_EQ(42, a, "I02_Dec");
+    ASSERT_EQ(31, b, "I03_Hex");
+    ASSERT_EQ(15, c, "I04_Oct");
+    ASSERT_EQ(5, d, "I05_Bin");
+}
+
+void test_i_signs_and_zero(void) {
+    // Test: Signs with prefixes, and a lone zero.
+    int a = 0, b = 0, c = -1;
+    prepare_input("-0x10 +010 0");
+    ASSERT_EQ(3, my_scanf("%i %i %i", &a, &b, &c), "I06_Ret");
+    ASSERT_EQ(-16, a, "I07_NegHex");
+    ASSERT_EQ(8, b, "I08_PosOct");
+    ASSERT_EQ(0, c, "I09_Zero");
+}
+
+void test_i_octal_stops_at_8(void) {
+    // Test: Octal mode stops at '8'.
+    int a = 0;
+    char next;
+    prepare_input("0758");
+    ASSERT_EQ(1, my_scanf("%i", &a), "I10_Ret");
+    ASSERT_EQ(61, a, "I11_Val");
+    my_scanf("%c", &next);
+    ASSERT_EQ('8', next, "I12_Stopper");
+}
+
+void test_i_length_modifier(void) {
+    // Test: %lli stores 64 bits.
+    long long a = 0;
+    prepare_input("0x7FFFFFFFFFFFFFFF");
+    ASSERT_EQ(1, my_scanf("%lli", &a), "I13_Ret");
+    ASSERT_EQ(0x7FFFFFFFFFFFFFFFLL, a, "I14_Val");
+}
+
+void test_u_basic(void) {
+    // Test: Unsigned decimal, full 32-bit range.
+    unsigned int a = 0, b = 0;
+    prepare_input("4294967295 123");
+    ASSERT_EQ(2, my_scanf("%u %u", &a, &b), "U21_Ret");
+    ASSERT_EQ(4294967295u, a, "U22_Max");
+    ASSERT_EQ(123u, b, "U23_Val");
+}
+
+void test_u_width_and_negative(void) {
+    // Test: Width limit; '-' wraps like standard scanf.
+    unsigned int a = 0, b = 0;
+    prepare_input("12345 -1");
+    ASSERT_EQ(2, my_scanf("%2u%*u %u", &a, &b), "U24_Ret");
+    ASSERT_EQ(12, a, "U25_Width");
+    ASSERT_EQ(4294967295u, b, "U26_Wrap");
+}
+
+void test_o_basic(void) {
+    // Test: Octal digits; '8' is not one.
+    unsigned int a = 0;
+    prepare_input("777");
+    ASSERT_EQ(1, my_scanf("%o", &a), "O01_Ret");
+    ASSERT_EQ(511, a, "O02_Val");
+    prepare_input("8");
+    ASSERT_EQ(0, my_scanf("%o", &a), "O03_Invalid");
+}
+
+void test_o_modifiers(void) {
+    // Test: %llo stores 64 bits.
+    unsigned long long a = 0;
+    prepare_input("1777777777777777777777");
+    ASSERT_EQ(1, my_scanf("%llo", &a), "O04_Ret");
+    ASSERT_EQ(0xFFFFFFFFFFFFFFFFULL, a, "O05_Max");
+}
+
+void test_radix_long_runs(void) {
+    // Test: Digit runs longer than one 8-digit SWAR chunk.
+    long long d = 0;
+    unsigned long long x = 0, b = 0;
+    prepare_input("1234567890123456789 0123456789abcdef 101010101010101010101");
+    ASSERT_EQ(3, my_scanf("%lld %llx %llb", &d, &x, &b), "RX01_Ret");
+    ASSERT_EQ(1234567890123456789LL, d, "RX02_Dec19");
+    ASSERT_EQ(0x0123456789abcdefULL, x, "RX03_Hex16");
+    ASSERT_EQ(0x155555ULL, b, "RX04_Bin21");
+}
+
+void test_radix_width_stopper_kept(void) {
+    // Test: When the width ends exactly at a stopper, the stopper stays.
+    unsigned int x = 0;
+    char next;
+    prepare_input("ff;");
+    ASSERT_EQ(1, my_scanf("%2x", &x), "RX05_Ret");
+    my_scanf("%c", &next);
+    ASSERT_EQ(';', next, "RX06_Stopper");
+}
+
+void test_i128_decimal(void) {
+    // Test: %I128d spans several 19-digit chunks, both signs.
+    __int128 a = 0, b = 0;
+    prepare_input("170141183460469231731687303715884105727 -170141183460469231731687303715884105728");
+    ASSERT_EQ(2, my_scanf("%I128d %I128d", &a, &b), "W01_Ret");
+    ASSERT_EQ(0x7FFFFFFFFFFFFFFFULL, (unsigned long long)(a >> 64), "W02_MaxHi");
+    ASSERT_EQ(0xFFFFFFFFFFFFFFFFULL, (unsigned long long)a, "W03_MaxLo");
+    ASSERT_EQ(0x8000000000000000ULL, (unsigned long long)((unsigned __int128)b >> 64), "W04_MinHi");
+    ASSERT_EQ(0ULL, (unsigned long long)b, "W05_MinLo");
+}
+
+void test_i128_hex(void) {
+    // Test: %I128x with prefix, and a partial last chunk.
+    unsigned __int128 a = 0, b = 0;
+    prepare_input("0xffffffffffffffffffffffffffffffff 123456789abcdef0123");
+    ASSERT_EQ(2, my_scanf("%I128x %I128x", &a, &b), "W06_Ret");
+    ASSERT_EQ(0xFFFFFFFFFFFFFFFFULL, (unsigned long long)(a >> 64), "W07_AllHi");
+    ASSERT_EQ(0xFFFFFFFFFFFFFFFFULL, (unsigned long long)a, "W08_AllLo");
+    ASSERT_EQ(0x123ULL, (unsigned long long)(b >> 64), "W09_Hi");
+    ASSERT_EQ(0x456789abcdef0123ULL, (unsigned long long)b, "W10_Lo");
+}
+
+void test_i128_wrap_and_width(void) {
+    // Test: Wraps modulo 2^128 like the 64-bit engines; width splits fields.
+    unsigned __int128 a = 0;
+    __int128 b = 0, c = 0;
+    prepare_input("340282366920938463463374607431768211457 12345 0x10");
+    ASSERT_EQ(4, my_scanf("%I128u %3I128d%I128d %I128i", &a, &b, &c, &c), "W11_Ret");
+    ASSERT_EQ(1ULL, (unsigned long long)a, "W12_Wrap");
+    ASSERT_EQ(123LL, (long long)b, "W13_Width");
+    ASSERT_EQ(16LL, (long long)c, "W14_AutoHex");
+}
+
+void test_i128_suppress_octal(void) {
+    // Test: %*I128o consumes without storing; octal crosses a 21-digit chunk.
+    unsigned __int128 a = 0;
+    prepare_input("777 3777777777777777777777777");
+    ASSERT_EQ(1, my_scanf("%*I128o %I128o", &a), "W15_Ret");
+    ASSERT_EQ(0x3FFULL, (unsigned long long)(a >> 64), "W16_Hi");
+    ASSERT_EQ(0xFFFFFFFFFFFFFFFFULL, (unsigned long long)a, "W17_Lo");
+}
+
 /* =========================================================================
  * CHARACTER TESTS (%c)
  * ========================================================================= */
@@ -1167,6 +1315,73 @@ void test_f_valid_dot_exponent(void) {
     ASSERT_DBL_NEAR(100.0, x, 1e-5, "F34_DotExp");
 }
 
+// Helper: Raw IEEE-754 bits of a double, for exact comparisons.
+static long long dbl_bits(double d) {
+    long long bits;
+    memcpy(&bits, &d, sizeof bits);
+    return bits;
+}
+
+void test_a_hex_basic(void) {
+    // Test: %la reads hex floats; %a stores to float.
+    double d = 0;
+    float f = 0;
+    prepare_input("0x1.8p+3 -0X1P-2");
+    ASSERT_EQ(2, my_scanf("%la %a", &d, &f), "F35_Hex_Ret");
+    ASSERT_DBL_NEAR(12.0, d, 0, "F36_Hex_Val");
+    ASSERT_DBL_NEAR(-0.25, f, 0, "F37_Hex_Float");
+}
+
+void test_a_hex_exact_extremes(void) {
+    // Test: Largest normal, smallest subnormal and -0 come back bit for bit.
+    double a = 0, b = 0, c = 0;
+    prepare_input("0x1.fffffffffffffp+1023 0x0.0000000000001p-1022 -0x0p+0");
+    ASSERT_EQ(3, my_scanf("%la %la %la", &a, &b, &c), "F38_Ext_Ret");
+    ASSERT_EQ(0x7FEFFFFFFFFFFFFFLL, dbl_bits(a), "F39_DblMax");
+    ASSERT_EQ(1LL, dbl_bits(b), "F40_MinSub");
+    ASSERT_EQ((long long)0x8000000000000000ULL, dbl_bits(c), "F41_NegZero");
+}
+
+void test_a_hex_rounding(void) {
+    // Test: Ties go to even; any bit beyond the tie (sticky) rounds up.
+    double a = 0, b = 0, c = 0, d = 0;
+    prepare_input("0x1.00000000000008p0 0x1.00000000000018p0 "
+                  "0x1.000000000000080000000001p0 0x1p2000");
+    ASSERT_EQ(4, my_scanf("%la %la %la %la", &a, &b, &c, &d), "F42_Rnd_Ret");
+    ASSERT_EQ(0x3FF0000000000000LL, dbl_bits(a), "F43_TieEven");
+    ASSERT_EQ(0x3FF0000000000002LL, dbl_bits(b), "F44_TieUp");
+    ASSERT_EQ(0x3FF0000000000001LL, dbl_bits(c), "F45_Sticky");
+    ASSERT_EQ(0x7FF0000000000000LL, dbl_bits(d), "F46_Overflow");
+}
+
+void test_a_hex_width_and_rollback(void) {
+    // Test: Width cuts before 'p'; "p+" without digits and "0x" without
+    // digits are handed back.
+    double a = 0, b = 0, c = 0;
+    char rest[8] = {0};
+    prepare_input("0x1p4 0x1p+z 0xg");
+    ASSERT_EQ(1, my_scanf("%4la", &a), "F47_Width_Ret");
+    ASSERT_DBL_NEAR(1.0, a, 0, "F48_Width_Val");
+    ASSERT_EQ(3, my_scanf("%2s %la%2s", rest, &b, rest), "F49_Roll_Ret");
+    ASSERT_DBL_NEAR(1.0, b, 0, "F50_Roll_Val");
+    ASSERT_STREQ("p+", rest, "F51_Roll_Rest");
+    ASSERT_EQ(2, my_scanf("%*s %la%s", &c, rest), "F52_Zero_Ret");
+    ASSERT_STREQ("xg", rest, "F53_Zero_Rest");
+}
+
+void test_e_g_specifiers(void) {
+    // Test: %e, %g, %E, %G and %F share the float engine.
+    float a = 0, b = 0;
+    double c = 0, d = 0, e = 0;
+    prepare_input("1.5e2 -2.5 3E-1 0x10 7");
+    ASSERT_EQ(5, my_scanf("%e %g %lE %lG %lF", &a, &b, &c, &d, &e), "F54_EG_Ret");
+    ASSERT_DBL_NEAR(150.0, a, 1e-5, "F55_e");
+    ASSERT_DBL_NEAR(-2.5, b, 1e-5, "F56_g");
+    ASSERT_DBL_NEAR(0.3, c, 1e-9, "F57_E");
+    ASSERT_DBL_NEAR(16.0, d, 0, "F58_G_Hex");
+    ASSERT_DBL_NEAR(7.0, e, 0, "F59_F");
+}
+
 /* =========================================================================
  * BINARY TESTS (%b)
  * ========================================================================= */
@@ -1729,6 +1944,419 @@ void test_D_complex_suppress(void) {
     ASSERT_EQ(500, x, "D40_Val");
 }
 
+/* --- FAST PATH TESTS (Fixed 10-byte layout) --- */
+
+void test_D_fast_long_year_fallback(void) {
+    // Test: An 11th digit is not the fixed layout; the year keeps growing.
+    Date d;
+    prepare_input("01/02/20245 ");
+    ASSERT_EQ(1, my_scanf("%D", &d), "D41_LongYear");
+    ASSERT_EQ(20245, d.year, "D42_Year");
+}
+
+void test_D_fast_width_ten(void) {
+    // Test: Width 10 stops the year at 4 digits and leaves the rest.
+    Date d;
+    char next;
+    prepare_input("01/02/20245");
+    ASSERT_EQ(1, my_scanf("%10D", &d), "D43_Width10");
+    ASSERT_EQ(2024, d.year, "D44_Year");
+    my_scanf("%c", &next);
+    ASSERT_EQ('5', next, "D45_Stopper");
+}
+
+void test_D_fast_variable_width_fallback(void) {
+    // Test: Single-digit day/month still parse through the general path.
+    Date d;
+    char next;
+    prepare_input("1/12/2024;");
+    ASSERT_EQ(1, my_scanf("%D", &d), "D46_Variable");
+    ASSERT_EQ(1, d.day, "D47_Day");
+    ASSERT_EQ(12, d.month, "D48_Month");
+    my_scanf("%c", &next);
+    ASSERT_EQ(';', next, "D49_Stopper");
+}
+
+void test_D_fast_invalid_calendar(void) {
+    // Test: Fixed layout but impossible day still fails, stopper intact.
+    Date d;
+    char next;
+    prepare_input("31/04/2024X");
+    ASSERT_EQ(0, my_scanf("%D", &d), "D50_FastInvalid");
+    my_scanf("%c", &next);
+    ASSERT_EQ('X', next, "D51_Stopper");
+}
+
+void test_D_fast_short_input(void) {
+    // Test: Input ending before 10 bytes falls back cleanly.
+    Date d;
+    prepare_input("01/02/20");
+    ASSERT_EQ(1, my_scanf("%D", &d), "D52_Short");
+    ASSERT_EQ(20, d.year, "D53_Year");
+}
+
+void test_D_fast_many_records(void) {
+    // Test: Consecutive fixed-layout dates on separate lines.
+    Date a, b, c;
+    prepare_input("28/02/2023\n29-02-2024\n31/12/1999\n");
+    ASSERT_EQ(3, my_scanf("%D %D %D", &a, &b, &c), "D54_Many");
+    ASSERT_EQ(28, a.day, "D55_A");
+    ASSERT_EQ(29, b.day, "D56_B");
+    ASSERT_EQ(1999, c.year, "D57_C");
+}
+
+void test_D_cache_hits(void) {
+    // Test: Repeated dates are served from the cache and counted.
+    Date a, b, c;
+    ScanStats st;
+    my_scanf_date_cache(1);
+    my_scanf_reset_stats();
+    prepare_input("16/10/2026 16/10/2026 17/10/2026");
+    ASSERT_EQ(3, my_scanf("%D %D %D", &a, &b, &c), "D58_CacheRet");
+    ASSERT_EQ(16, b.day, "D59_HitDay");
+    ASSERT_EQ(2026, b.year, "D60_HitYear");
+    ASSERT_EQ(17, c.day, "D61_MissDay");
+    my_scanf_get_stats(&st);
+    ASSERT_EQ(1, st.date_cache_hits, "D62_Hits");
+    ASSERT_EQ(2, st.date_cache_misses, "D63_Misses");
+    my_scanf_date_cache(0);
+}
+
+void test_D_cache_keeps_stopper(void) {
+    // Test: A cache hit still leaves the trailing character in place.
+    Date d;
+    char next;
+    my_scanf_date_cache(1);
+    prepare_input("01/01/2000;01/01/2000;");
+    ASSERT_EQ(1, my_scanf("%D;", &d), "D64_First");
+    ASSERT_EQ(1, my_scanf("%D", &d), "D65_Second");
+    my_scanf("%c", &next);
+    ASSERT_EQ(';', next, "D66_Stopper");
+    my_scanf_date_cache(0);
+}
+
+void test_D_cache_invalid_not_cached(void) {
+    // Test: An invalid date is never cached; it fails every time.
+    Date d;
+    my_scanf_date_cache(1);
+    prepare_input("29/02/2023 29/02/2023\n");
+    ASSERT_EQ(0, my_scanf("%D", &d), "D67_First");
+    ASSERT_EQ(0, my_scanf(" %D", &d), "D68_Second");
+    my_scanf_date_cache(0);
+}
+
+void test_D_cache_disabled_no_stats(void) {
+    // Test: With the cache off, counters do not move.
+    Date d;
+    ScanStats st;
+    my_scanf_reset_stats();
+    prepare_input("01/01/2000 01/01/2000");
+    my_scanf("%D %D", &d, &d);
+    my_scanf_get_stats(&st);
+    ASSERT_EQ(0, st.date_cache_hits + st.date_cache_misses, "D69_NoStats");
+}
+
+void test_D_days_epoch(void) {
+    // Test: %lD yields 0 for the epoch and counts forward from there.
+    int32_t a = -1, b = -1;
+    prepare_input("01/01/1970 02-01-1970");
+    ASSERT_EQ(2, my_scanf("%lD %lD", &a, &b), "D70_DaysRet");
+    ASSERT_EQ(0, a, "D71_Epoch");
+    ASSERT_EQ(1, b, "D72_NextDay");
+}
+
+void test_D_days_leap_and_modern(void) {
+    // Test: Leap day, March after a leap February, and a recent date.
+    int32_t a = 0, b = 0, c = 0;
+    prepare_input("29/02/2024 01/03/2000 16/10/2026");
+    ASSERT_EQ(3, my_scanf("%lD %lD %lD", &a, &b, &c), "D73_DaysRet");
+    ASSERT_EQ(19782, a, "D74_Leap");
+    ASSERT_EQ(11017, b, "D75_March");
+    ASSERT_EQ(20742, c, "D76_Recent");
+}
+
+void test_D_days_before_epoch(void) {
+    // Test: Dates before 1970 are negative.
+    int32_t a = 0, b = 0;
+    prepare_input("31/12/1969 1/1/1");
+    ASSERT_EQ(2, my_scanf("%lD %lD", &a, &b), "D77_DaysRet");
+    ASSERT_EQ(-1, a, "D78_DayBefore");
+    ASSERT_EQ(-719162, b, "D79_YearOne");
+}
+
+void test_D_days_invalid(void) {
+    // Test: Calendar validation is shared with %D.
+    int32_t a = 123;
+    prepare_input("29/02/2023\n");
+    ASSERT_EQ(0, my_scanf("%lD", &a), "D80_DaysInvalid");
+    ASSERT_EQ(123, a, "D81_Untouched");
+}
+
+void test_D_days_suppressed(void) {
+    // Test: Suppressed %lD consumes the date without assigning.
+    int x = 0;
+    prepare_input("01/01/2000 7");
+    ASSERT_EQ(1, my_scanf("%*lD %d", &x), "D82_DaysSuppress");
+    ASSERT_EQ(7, x, "D83_Val");
+}
+
+void test_D_open_pipe_short_date(void) {
+    // Test: A short date on a pipe that stays open is returned at once;
+    // the fast path never waits for bytes the writer has not sent.
+    Date a;
+    ScanSource src;
+    int fds[2];
+    FILE *fp;
+
+    ASSERT_EQ(0, pipe(fds), "D84_Pipe");
+    fp = fdopen(fds[0], "r");
+    ASSERT_EQ(9, (long)write(fds[1], "1/1/2020\n", 9), "D85_Write");
+    my_scanf_source_file(&src, fp);
+    my_scanf_set_source(&src);
+    alarm(5);  // A regression blocks here; fail loudly instead of hanging
+    ASSERT_EQ(1, my_scanf(" %D", &a), "D86_NoBlock");
+    alarm(0);
+    my_scanf_set_source(NULL);
+    ASSERT_EQ(2020, a.year, "D87_Year");
+    fclose(fp);
+    close(fds[1]);
+}
+
+void test_D_stopper_not_buffered(void) {
+    // Test: With a 10-byte stdio buffer the stopper (or a 5th year digit)
+    // arrives in the next fill; the fast path reads it like the loops do.
+    Date a, b;
+    ScanSource src;
+    char vbuf[10];
+    int fds[2];
+    FILE *fp;
+
+    ASSERT_EQ(0, pipe(fds), "D88_Pipe");
+    ASSERT_EQ(22, (long)write(fds[1], "01/02/20245 03/04/2025", 22), "D89_Write");
+    close(fds[1]);
+    fp = fdopen(fds[0], "r");
+    setvbuf(fp, vbuf, _IOFBF, sizeof vbuf);
+    my_scanf_source_file(&src, fp);
+    my_scanf_set_source(&src);
+    ASSERT_EQ(2, my_scanf("%D %D", &a, &b), "D90_Ret");
+    my_scanf_set_source(NULL);
+    ASSERT_EQ(20245, a.year, "D91_LongYear");
+    ASSERT_EQ(3, b.day, "D92_Day");
+    ASSERT_EQ(2025, b.year, "D93_Year");
+    fclose(fp);
+}
+
+/* =========================================================================
+ * TIMESTAMP TESTS (%T) - Custom Specifier
+ * Format: YYYY-MM-DDTHH:MM:SS[.fraction][Z|+HH:MM|-HH:MM]
+ * ========================================================================= */
+
+void test_T_basic_utc_fraction(void) {
+    // Test: Microsecond fraction with 'Z'.
+    int64_t ns = 0;
+    prepare_input("2026-10-16T12:34:56.789012Z");
+    ASSERT_EQ(1, my_scanf("%T", &ns), "T01_Ret");
+    ASSERT_EQ(1792154096789012000LL, ns, "T02_Val");
+}
+
+void test_T_epoch(void) {
+    // Test: The epoch itself is zero.
+    int64_t ns = -1;
+    prepare_input("1970-01-01T00:00:00Z");
+    ASSERT_EQ(1, my_scanf("%T", &ns), "T03_Ret");
+    ASSERT_EQ(0, ns, "T04_Zero");
+}
+
+void test_T_no_zone_is_utc(void) {
+    // Test: Missing zone designator is treated as UTC.
+    int64_t ns = 0;
+    prepare_input("2024-02-29T00:00:00");
+    ASSERT_EQ(1, my_scanf("%T", &ns), "T05_Ret");
+    ASSERT_EQ(1709164800000000000LL, ns, "T06_Val");
+}
+
+void test_T_offsets(void) {
+    // Test: Positive and negative offsets are subtracted to reach UTC.
+    int64_t a = 0, b = 0;
+    prepare_input("2026-10-16T12:34:56+02:00 2026-10-16T12:34:56-05:30");
+    ASSERT_EQ(2, my_scanf("%T %T", &a, &b), "T07_Ret");
+    ASSERT_EQ(1792146896000000000LL, a, "T08_Plus");
+    ASSERT_EQ(1792173896000000000LL, b, "T09_Minus");
+}
+
+void test_T_nanoseconds(void) {
+    // Test: 9 fraction digits are kept exactly; extra digits are truncated.
+    int64_t a = 0, b = 0;
+    prepare_input("1970-01-01T00:00:00.000000001Z 1970-01-01T00:00:01.1234567899Z");
+    ASSERT_EQ(2, my_scanf("%T %T", &a, &b), "T10_Ret");
+    ASSERT_EQ(1, a, "T11_OneNs");
+    ASSERT_EQ(1123456789LL, b, "T12_Truncated");
+}
+
+void test_T_before_epoch(void) {
+    // Test: Negative values before 1970.
+    int64_t ns = 0;
+    prepare_input("1969-12-31T23:59:59Z");
+    ASSERT_EQ(1, my_scanf("%T", &ns), "T13_Ret");
+    ASSERT_EQ(-1000000000LL, ns, "T14_Val");
+}
+
+void test_T_invalid_calendar(void) {
+    // Test: Calendar validation is shared with %D; input is left untouched.
+    int64_t ns = 0;
+    char buf[32];
+    prepare_input("2023-02-29T10:00:00Z");
+    ASSERT_EQ(0, my_scanf("%T", &ns), "T15_Feb29");
+    my_scanf("%s", buf);
+    ASSERT_STREQ("2023-02-29T10:00:00Z", buf, "T16_Rollback");
+}
+
+void test_T_invalid_time(void) {
+    // Test: Hour 24 and minute 60 are rejected.
+    int64_t ns = 0;
+    prepare_input("2026-01-01T24:00:00Z\n");
+    ASSERT_EQ(0, my_scanf("%T", &ns), "T17_Hour24");
+    prepare_input("2026-01-01T10:60:00Z\n");
+    ASSERT_EQ(0, my_scanf("%T", &ns), "T18_Min60");
+}
+
+void test_T_bad_layout(void) {
+    // Test: Wrong separators fail.
+    int64_t ns = 0;
+    prepare_input("2026/10/16T12:34:56Z\n");
+    ASSERT_EQ(0, my_scanf("%T", &ns), "T19_Slashes");
+    prepare_input("2026-10-16 12:34:56Z\n");
+    ASSERT_EQ(0, my_scanf("%T", &ns), "T20_SpaceSep");
+}
+
+void test_T_stopper_left(void) {
+    // Test: Reading stops right after the zone.
+    int64_t ns = 0;
+    char next;
+    prepare_input("2026-10-16T12:34:56Z,next");
+    ASSERT_EQ(1, my_scanf("%T", &ns), "T21_Ret");
+    my_scanf("%c", &next);
+    ASSERT_EQ(',', next, "T22_Stopper");
+}
+
+void test_T_lone_dot_stopper(void) {
+    // Test: A '.' without digits is not a fraction and stays in the buffer.
+    int64_t ns = 0;
+    char next;
+    prepare_input("1970-01-01T00:00:01.x");
+    ASSERT_EQ(1, my_scanf("%T", &ns), "T23_Ret");
+    ASSERT_EQ(1000000000LL, ns, "T24_Val");
+    my_scanf("%c", &next);
+    ASSERT_EQ('.', next, "T25_Stopper");
+}
+
+void test_T_width(void) {
+    // Test: Width 19 reads only the head; below 19 fails.
+    int64_t ns = 0;
+    char next;
+    prepare_input("1970-01-01T00:00:05.5Z");
+    ASSERT_EQ(1, my_scanf("%19T", &ns), "T26_Width19");
+    ASSERT_EQ(5000000000LL, ns, "T27_Val");
+    my_scanf("%c", &next);
+    ASSERT_EQ('.', next, "T28_Stopper");
+
+    prepare_input("1970-01-01T00:00:05Z");
+    ASSERT_EQ(0, my_scanf("%18T", &ns), "T29_WidthFail");
+}
+
+void test_T_suppressed(void) {
+    // Test: Suppression with a following integer.
+    int x = 0;
+    prepare_input("2026-10-16T12:34:56.5+01:00 42");
+    ASSERT_EQ(1, my_scanf("%*T %d", &x), "T30_Suppress");
+    ASSERT_EQ(42, x, "T31_Val");
+}
+
+void test_T_int64_limits(void) {
+    // Test: Both ends of int64 nanoseconds are accepted exactly.
+    int64_t a = 0, b = 0, c = 0;
+    prepare_input("2262-04-11T23:47:16.854775807Z 1677-09-21T00:12:43.145224192Z 1677-09-21T00:12:44Z");
+    ASSERT_EQ(3, my_scanf("%T %T %T", &a, &b, &c), "T32_Ret");
+    ASSERT_EQ(1, a == INT64_MAX, "T33_Max");
+    ASSERT_EQ(1, b == INT64_MIN, "T34_Min");
+    ASSERT_EQ(1, c == -9223372036000000000LL, "T35_NearMin");
+}
+
+void test_T_out_of_range_untouched(void) {
+    // Test: Past the limits fails and leaves the text in place; an offset
+    // can still bring a late local time into range.
+    int64_t ns = 0;
+    char buf[40];
+    prepare_input("2262-04-11T23:47:16.854775808Z 2262-04-12T00:00:00Z 2262-04-12T05:00:00+06:00");
+    ASSERT_EQ(0, my_scanf("%T", &ns), "T36_OneNsOver");
+    my_scanf("%s", buf);
+    ASSERT_STREQ("2262-04-11T23:47:16.854775808Z", buf, "T37_Untouched");
+    ASSERT_EQ(0, my_scanf(" %T", &ns), "T38_DayOver");
+    my_scanf("%s", buf);
+    ASSERT_STREQ("2262-04-12T00:00:00Z", buf, "T39_Untouched");
+    ASSERT_EQ(1, my_scanf(" %T", &ns), "T40_OffsetInRange");
+    ASSERT_EQ(9223369200000000000LL, ns, "T41_Val");
+}
+
+void test_T_open_pipe(void) {
+    // Test: A complete timestamp on a pipe that stays open is returned
+    // without waiting for more input.
+    int64_t ns = 0;
+    ScanSource src;
+    int fds[2];
+    FILE *fp;
+
+    ASSERT_EQ(0, pipe(fds), "T42_Pipe");
+    fp = fdopen(fds[0], "r");
+    ASSERT_EQ(21, (long)write(fds[1], "1970-01-01T00:00:07Z\n", 21), "T43_Write");
+    my_scanf_source_file(&src, fp);
+    my_scanf_set_source(&src);
+    alarm(5);  // A regression blocks here; fail loudly instead of hanging
+    ASSERT_EQ(1, my_scanf("%T", &ns), "T44_NoBlock");
+    alarm(0);
+    my_scanf_set_source(NULL);
+    ASSERT_EQ(7000000000LL, ns, "T45_Val");
+
+    // Too short to be a timestamp: decided by the first byte out of place
+    ASSERT_EQ(4, (long)write(fds[1], "12:\n", 4), "T53_Write");
+    my_scanf_set_source(&src);
+    alarm(5);
+    ASSERT_EQ(0, my_scanf(" %T", &ns), "T54_ShortNoBlock");
+    alarm(0);
+    my_scanf_set_source(NULL);
+    fclose(fp);
+    close(fds[1]);
+}
+
+void test_T_small_stream_buffer(void) {
+    // Test: With a 10-byte stdio buffer the timestamp is read a character
+    // at a time: a 40-digit fraction is truncated, and a failure pushes
+    // back only the last character read.
+    int64_t a = 0, b = 0;
+    char rest[8];
+    ScanSource src;
+    char vbuf[10];
+    int fds[2];
+    FILE *fp;
+    const char *text = "1970-01-01T00:00:01.1234567890123456789012345678901234567890+01:00 "
+                       "2026-13-01T00:00:00Z";
+
+    ASSERT_EQ(0, pipe(fds), "T46_Pipe");
+    ASSERT_EQ((long)strlen(text), (long)write(fds[1], text, strlen(text)), "T47_Write");
+    close(fds[1]);
+    fp = fdopen(fds[0], "r");
+    setvbuf(fp, vbuf, _IOFBF, sizeof vbuf);
+    my_scanf_source_file(&src, fp);
+    my_scanf_set_source(&src);
+    ASSERT_EQ(1, my_scanf("%T", &a), "T48_Ret");
+    ASSERT_EQ(-3600LL * 1000000000LL + 1123456789LL, a, "T49_LongFraction");
+    ASSERT_EQ(0, my_scanf(" %T", &b), "T50_BadMonth");
+    ASSERT_EQ(1, my_scanf("%7s", rest), "T51_Rest");
+    my_scanf_set_source(NULL);
+    ASSERT_STREQ("0Z", rest, "T52_OneCharBack");
+    fclose(fp);
+}
+
 /* =========================================================================
  * COLOR TESTS (%R) - Custom Specifier
  * Format: #RRGGBB (Hexadecimal)
@@ -1927,6 +2555,1923 @@ void test_R_suppress_complex(void) {
     ASSERT_EQ(187, c.r, "R40_ColorVal");
 }
 
+/* --- PACKED RGBA TESTS (%lR) --- */
+
+void test_R_packed_rrggbb(void) {
+    // Test: 6 digits get an opaque alpha.
+    uint32_t c = 0;
+    prepare_input("#FFA07A");
+    ASSERT_EQ(1, my_scanf("%lR", &c), "R41_Ret");
+    ASSERT_EQ(0xFFA07AFFu, c, "R42_Val");
+}
+
+void test_R_packed_rrggbbaa(void) {
+    // Test: 8 digits carry their own alpha; lowercase accepted.
+    uint32_t c = 0;
+    prepare_input("#11223380");
+    ASSERT_EQ(1, my_scanf("%lR", &c), "R43_Ret");
+    ASSERT_EQ(0x11223380u, c, "R44_Val");
+}
+
+void test_R_packed_short_forms(void) {
+    // Test: #RGB and #RGBA expand each nibble.
+    uint32_t a = 0, b = 0;
+    prepare_input("#f80 #abc4");
+    ASSERT_EQ(2, my_scanf("%lR %lR", &a, &b), "R45_Ret");
+    ASSERT_EQ(0xFF8800FFu, a, "R46_RGB");
+    ASSERT_EQ(0xAABBCC44u, b, "R47_RGBA");
+}
+
+void test_R_packed_odd_length(void) {
+    // Test: 7 digits -> #RRGGBB, the 7th digit is left in the buffer.
+    uint32_t c = 0;
+    char next;
+    prepare_input("#1122334");
+    ASSERT_EQ(1, my_scanf("%lR", &c), "R48_Ret");
+    ASSERT_EQ(0x112233FFu, c, "R49_Val");
+    my_scanf("%c", &next);
+    ASSERT_EQ('4', next, "R50_Stopper");
+}
+
+void test_R_packed_too_short(void) {
+    // Test: Fewer than 3 digits fails.
+    uint32_t c = 0;
+    prepare_input("#12 x");
+    ASSERT_EQ(0, my_scanf("%lR", &c), "R51_TooShort");
+}
+
+void test_R_packed_width(void) {
+    // Test: Width 4 ('#' + 3) forces the short form.
+    uint32_t c = 0;
+    char next;
+    prepare_input("#123456");
+    ASSERT_EQ(1, my_scanf("%4lR", &c), "R52_Ret");
+    ASSERT_EQ(0x112233FFu, c, "R53_Val");
+    my_scanf("%c", &next);
+    ASSERT_EQ('4', next, "R54_Stopper");
+}
+
+void test_R_packed_missing_hash(void) {
+    // Test: '#' is mandatory and not consumed on failure.
+    uint32_t c = 0;
+    char next;
+    prepare_input("FFFFFF");
+    ASSERT_EQ(0, my_scanf("%lR", &c), "R55_NoHash");
+    my_scanf("%c", &next);
+    ASSERT_EQ('F', next, "R56_Rollback");
+}
+
+void test_R_packed_suppressed(void) {
+    // Test: Suppression then a normal packed read.
+    uint32_t c = 0;
+    prepare_input("#000 #FFFFFF00");
+    ASSERT_EQ(1, my_scanf("%*lR %lR", &c), "R57_Suppress");
+    ASSERT_EQ(0xFFFFFF00u, c, "R58_Val");
+}
+
+/* =========================================================================
+ * NETWORK ADDRESS TESTS (%N = IPv4, %lN = IPv6) - Custom Specifier
+ * ========================================================================= */
+
+void test_N_ipv4_basic(void) {
+    // Test: Dotted quad into 4 network-order bytes.
+    unsigned char a[4] = {0};
+    prepare_input("192.168.1.254");
+    ASSERT_EQ(1, my_scanf("%N", a), "N01_Ret");
+    ASSERT_EQ(192, a[0], "N02_A");
+    ASSERT_EQ(168, a[1], "N03_B");
+    ASSERT_EQ(1, a[2], "N04_C");
+    ASSERT_EQ(254, a[3], "N05_D");
+}
+
+void test_N_ipv4_port_stopper(void) {
+    // Test: Stops before ":port"; the port can be read next.
+    unsigned char a[4] = {0};
+    int port = 0;
+    prepare_input("  10.0.0.1:8080");
+    ASSERT_EQ(2, my_scanf("%N:%d", a, &port), "N06_Ret");
+    ASSERT_EQ(10, a[0], "N07_First");
+    ASSERT_EQ(8080, port, "N08_Port");
+}
+
+void test_N_ipv4_invalid(void) {
+    // Test: Out-of-range octet, leading zero, and too few octets fail.
+    unsigned char a[4] = {0};
+    prepare_input("256.1.1.1\n");
+    ASSERT_EQ(0, my_scanf("%N", a), "N09_Range");
+    prepare_input("10.01.1.1\n");
+    ASSERT_EQ(0, my_scanf("%N", a), "N10_LeadingZero");
+    prepare_input("10.1.1\n");
+    ASSERT_EQ(0, my_scanf("%N", a), "N11_Short");
+}
+
+void test_N_ipv4_width(void) {
+    // Test: Width cuts the last octet ("1.2.3.4" of "1.2.3.45").
+    unsigned char a[4] = {0};
+    char next;
+    prepare_input("1.2.3.45");
+    ASSERT_EQ(1, my_scanf("%7N", a), "N12_Ret");
+    ASSERT_EQ(4, a[3], "N13_Cut");
+    my_scanf("%c", &next);
+    ASSERT_EQ('5', next, "N14_Stopper");
+}
+
+void test_N_ipv6_full(void) {
+    // Test: All 8 groups.
+    unsigned char a[16] = {0};
+    prepare_input("2001:0db8:85a3:0000:0000:8a2e:0370:7334");
+    ASSERT_EQ(1, my_scanf("%lN", a), "N15_Ret");
+    ASSERT_EQ(0x20, a[0], "N16_B0");
+    ASSERT_EQ(0x01, a[1], "N17_B1");
+    ASSERT_EQ(0x8a, a[10], "N18_B10");
+    ASSERT_EQ(0x34, a[15], "N19_B15");
+}
+
+void test_N_ipv6_compressed(void) {
+    // Test: "::" in the middle, at the start, and alone.
+    unsigned char a[16], b[16], c[16];
+    memset(c, 0xAA, sizeof(c));
+    prepare_input("fe80::1 ::1 ::");
+    ASSERT_EQ(3, my_scanf("%lN %lN %lN", a, b, c), "N20_Ret");
+    ASSERT_EQ(0xfe, a[0], "N21_Prefix");
+    ASSERT_EQ(0, a[7], "N22_Zeros");
+    ASSERT_EQ(1, a[15], "N23_Suffix");
+    ASSERT_EQ(0, b[14], "N24_Loopback0");
+    ASSERT_EQ(1, b[15], "N25_Loopback1");
+    ASSERT_EQ(0, c[0] | c[8] | c[15], "N26_AllZero");
+}
+
+void test_N_ipv6_embedded_ipv4(void) {
+    // Test: IPv4-mapped address with a dotted-quad tail.
+    unsigned char a[16] = {0};
+    prepare_input("::ffff:192.0.2.128");
+    ASSERT_EQ(1, my_scanf("%lN", a), "N27_Ret");
+    ASSERT_EQ(0xff, a[10], "N28_FF");
+    ASSERT_EQ(192, a[12], "N29_Quad0");
+    ASSERT_EQ(128, a[15], "N30_Quad3");
+}
+
+void test_N_ipv6_invalid(void) {
+    // Test: Two "::", too few groups, and 5-digit group fail.
+    unsigned char a[16] = {0};
+    prepare_input("1::2::3\n");
+    ASSERT_EQ(0, my_scanf("%lN", a), "N31_DoubleGap");
+    prepare_input("1:2:3:4:5:6:7\n");
+    ASSERT_EQ(0, my_scanf("%lN", a), "N32_Short");
+    prepare_input("12345::1\n");
+    ASSERT_EQ(0, my_scanf("%lN", a), "N33_LongGroup");
+}
+
+void test_N_ipv6_stopper(void) {
+    // Test: Zone id / brackets are left for the caller.
+    unsigned char a[16] = {0};
+    char next;
+    prepare_input("fe80::abcd%eth0");
+    ASSERT_EQ(1, my_scanf("%lN", a), "N34_Ret");
+    ASSERT_EQ(0xcd, a[15], "N35_Val");
+    my_scanf("%c", &next);
+    ASSERT_EQ('%', next, "N36_Stopper");
+}
+
+void test_N_suppressed(void) {
+    // Test: Suppress client address, read server address.
+    unsigned char a[4] = {0};
+    prepare_input("10.0.0.1 10.0.0.2");
+    ASSERT_EQ(1, my_scanf("%*N %N", a), "N37_Suppress");
+    ASSERT_EQ(2, a[3], "N38_Val");
+}
+
+void test_N_memory_window(void) {
+    // Test: Buffered addresses are parsed in place; the stopper, width and
+    // a buffer that ends right after the address match the stream path.
+    const char *text = "10.20.30.40:80 1.2.3.45 fe80::1:2%eth0 1:2:3:4:5:6:7:8:9 ::ffff:1.2.3.4 ::";
+    unsigned char a[4] = {0}, b[16] = {0};
+    char next = 0;
+    int port = 0;
+    ScanSource src;
+
+    my_scanf_source_memory(&src, text, strlen(text));
+    my_scanf_set_source(&src);
+    ASSERT_EQ(2, my_scanf("%N:%d", a, &port), "N39_Ret");
+    ASSERT_EQ(40, a[3], "N40_Last");
+    ASSERT_EQ(80, port, "N41_Port");
+    ASSERT_EQ(1, my_scanf(" %7N", a), "N42_Width");
+    ASSERT_EQ(4, a[3], "N43_WidthCut");
+    ASSERT_EQ(1, my_scanf("%c", &next), "N44_WidthRest");
+    ASSERT_EQ('5', next, "N45_WidthChar");
+    ASSERT_EQ(1, my_scanf("%lN", b), "N46_Gap");
+    ASSERT_EQ(0xfe, b[0], "N47_GapHead");
+    ASSERT_EQ(2, b[15], "N48_GapTail");
+    ASSERT_EQ(1, my_scanf("%c", &next), "N49_Zone");
+    ASSERT_EQ('%', next, "N50_ZoneChar");
+    ASSERT_EQ(1, my_scanf("%*s %lN", b), "N51_EightGroups");
+    ASSERT_EQ(8, b[15], "N52_EighthGroup");
+    ASSERT_EQ(1, my_scanf("%c", &next), "N53_NinthLeft");
+    ASSERT_EQ(':', next, "N54_NinthChar");
+    ASSERT_EQ(1, my_scanf("%*s %lN", b), "N55_DottedTail");
+    ASSERT_EQ(0xff, b[11], "N56_Mapped");
+    ASSERT_EQ(4, b[15], "N57_Quad3");
+    ASSERT_EQ(1, my_scanf("%lN", b), "N58_FinalGap");
+    ASSERT_EQ(strlen(text), my_scanf_tell(), "N59_End");
+    my_scanf_set_source(NULL);
+}
+
+void test_N_memory_invalid(void) {
+    // Test: A bad address in the buffer consumes what the character loop
+    // would have read before failing.
+    const char *text = "10.01.1.1 1::2::3 ";
+    unsigned char a[16] = {0};
+    char next = 0;
+    ScanSource src;
+
+    my_scanf_source_memory(&src, text, strlen(text));
+    my_scanf_set_source(&src);
+    ASSERT_EQ(0, my_scanf("%N", a), "N60_LeadingZero");
+    ASSERT_EQ(1, my_scanf("%c", &next), "N61_ZeroStopper");
+    ASSERT_EQ('1', next, "N62_ZeroChar");
+    ASSERT_EQ(0, my_scanf("%*s %lN", a), "N63_DoubleGap");
+    ASSERT_EQ(1, my_scanf("%c", &next), "N64_GapStopper");
+    ASSERT_EQ(':', next, "N65_GapChar");
+    my_scanf_set_source(NULL);
+}
+
+void test_N_block_boundaries(void) {
+    // Test: Addresses split over small pipe blocks are read whole.
+    const char *text = "192.168.100.200 2001:db8:aaaa:bbbb:cccc:dddd:eeee:ffff;";
+    unsigned char a[4] = {0}, b[16] = {0};
+    ScanSource src;
+    int fds[2];
+
+    ASSERT_EQ(0, pipe(fds), "N66_Pipe");
+    ASSERT_EQ((long)strlen(text), (long)write(fds[1], text, strlen(text)), "N67_Write");
+    close(fds[1]);
+    ASSERT_EQ(1, my_scanf_source_fd(&src, fds[0], 7), "N68_Open");
+    my_scanf_set_source(&src);
+    ASSERT_EQ(2, my_scanf("%N %lN;", a, b), "N69_Ret");
+    ASSERT_EQ(200, a[3], "N70_V4");
+    ASSERT_EQ(0xff, b[15], "N71_V6");
+    ASSERT_EQ(strlen(text), my_scanf_tell(), "N72_Offset");
+    my_scanf_set_source(NULL);
+    my_scanf_source_close(&src);
+    close(fds[0]);
+}
+
+/* =========================================================================
+ * UUID TESTS (%U) - Custom Specifier
+ * Format: 8-4-4-4-12 hex digits
+ * ========================================================================= */
+
+void test_U_basic(void) {
+    // Test: Canonical lowercase UUID into 16 bytes.
+    unsigned char u[16] = {0};
+    prepare_input("123e4567-e89b-12d3-a456-426614174000");
+    ASSERT_EQ(1, my_scanf("%U", u), "U01_Ret");
+    ASSERT_EQ(0x12, u[0], "U02_B0");
+    ASSERT_EQ(0x3e, u[1], "U03_B1");
+    ASSERT_EQ(0xe8, u[4], "U04_B4");
+    ASSERT_EQ(0xa4, u[8], "U05_B8");
+    ASSERT_EQ(0x00, u[15], "U06_B15");
+}
+
+void test_U_uppercase_mixed(void) {
+    // Test: Uppercase and mixed case digits.
+    unsigned char u[16] = {0};
+    prepare_input("  FFFFFFFF-ffff-AbCd-0000-0123456789AB");
+    ASSERT_EQ(1, my_scanf("%U", u), "U07_Ret");
+    ASSERT_EQ(0xFF, u[0], "U08_FF");
+    ASSERT_EQ(0xAB, u[6], "U09_Ab");
+    ASSERT_EQ(0xCD, u[7], "U10_Cd");
+    ASSERT_EQ(0xAB, u[15], "U11_Last");
+}
+
+void test_U_bad_dash_rollback(void) {
+    // Test: Misplaced dash fails and the text stays in the buffer.
+    unsigned char u[16] = {0};
+    char buf[64];
+    prepare_input("123e4567e-89b-12d3-a456-42661417400");
+    ASSERT_EQ(0, my_scanf("%U", u), "U12_BadDash");
+    my_scanf("%s", buf);
+    ASSERT_STREQ("123e4567e-89b-12d3-a456-42661417400", buf, "U13_Rollback");
+}
+
+void test_U_bad_hex(void) {
+    // Test: Non-hex digit in the last group fails.
+    unsigned char u[16] = {0};
+    prepare_input("123e4567-e89b-12d3-a456-42661417400g\n");
+    ASSERT_EQ(0, my_scanf("%U", u), "U14_BadHex");
+}
+
+void test_U_too_short(void) {
+    // Test: Truncated input fails.
+    unsigned char u[16] = {0};
+    prepare_input("123e4567-e89b-12d3-a456\n");
+    ASSERT_EQ(0, my_scanf("%U", u), "U15_Short");
+}
+
+void test_U_width(void) {
+    // Test: Width below 36 cannot hold a UUID.
+    unsigned char u[16] = {0};
+    prepare_input("123e4567-e89b-12d3-a456-426614174000");
+    ASSERT_EQ(0, my_scanf("%35U", u), "U16_Width");
+    ASSERT_EQ(1, my_scanf("%36U", u), "U17_WidthOK");
+}
+
+void test_U_flow_and_suppress(void) {
+    // Test: Suppress one UUID, keep the next, and the stopper survives.
+    unsigned char u[16] = {0};
+    char next;
+    prepare_input("00000000-0000-0000-0000-000000000000 ffffffff-ffff-ffff-ffff-fffffffffffe;");
+    ASSERT_EQ(1, my_scanf("%*U %U", u), "U18_Ret");
+    ASSERT_EQ(0xFE, u[15], "U19_Val");
+    my_scanf("%c", &next);
+    ASSERT_EQ(';', next, "U20_Stopper");
+}
+
+void test_U_open_pipe_short(void) {
+    // Test: A short token on a pipe that stays open fails at once instead
+    // of waiting for 36 characters.
+    unsigned char u[16] = {0};
+    char buf[8];
+    ScanSource src;
+    int fds[2];
+    FILE *fp;
+
+    ASSERT_EQ(0, pipe(fds), "U21_Pipe");
+    fp = fdopen(fds[0], "r");
+    ASSERT_EQ(4, (long)write(fds[1], "123\n", 4), "U22_Write");
+    my_scanf_source_file(&src, fp);
+    my_scanf_set_source(&src);
+    alarm(5);  // A regression blocks here; fail loudly instead of hanging
+    ASSERT_EQ(0, my_scanf("%U", u), "U23_NoBlock");
+    alarm(0);
+    ASSERT_EQ(1, my_scanf("%7s", buf), "U24_Rest");
+    my_scanf_set_source(NULL);
+    ASSERT_STREQ("123", buf, "U25_Untouched");
+    fclose(fp);
+    close(fds[1]);
+}
+
+void test_U_small_stream_buffer(void) {
+    // Test: With a 10-byte stdio buffer the UUID is read a character at a
+    // time; a mismatch past the buffer pushes back only that character.
+    unsigned char u[16] = {0};
+    char buf[40];
+    ScanSource src;
+    char vbuf[10];
+    int fds[2];
+    FILE *fp;
+    const char *text = "123e4567-e89b-12d3-a456-426614174000 123e4567-e89b-12d3-a456x";
+
+    ASSERT_EQ(0, pipe(fds), "U26_Pipe");
+    ASSERT_EQ((long)strlen(text), (long)write(fds[1], text, strlen(text)), "U27_Write");
+    close(fds[1]);
+    fp = fdopen(fds[0], "r");
+    setvbuf(fp, vbuf, _IOFBF, sizeof vbuf);
+    my_scanf_source_file(&src, fp);
+    my_scanf_set_source(&src);
+    ASSERT_EQ(1, my_scanf("%U", u), "U28_Ret");
+    ASSERT_EQ(0x00, u[15], "U29_Last");
+    ASSERT_EQ(0x12, u[0], "U30_First");
+    ASSERT_EQ(0, my_scanf(" %U", u), "U31_Bad");
+    ASSERT_EQ(1, my_scanf("%39s", buf), "U32_Rest");
+    my_scanf_set_source(NULL);
+    ASSERT_STREQ("x", buf, "U33_OneCharBack");
+    fclose(fp);
+}
+
+/* =========================================================================
+ * BASE64 TESTS (%B) - Custom Specifier
+ * Arguments: unsigned char *buffer, size_t *decoded_len
+ * ========================================================================= */
+
+void test_B_padded(void) {
+    // Test: One '=' of padding.
+    unsigned char buf[16] = {0};
+    size_t n = 0;
+    prepare_input("SGVsbG8=");
+    ASSERT_EQ(1, my_scanf("%B", buf, &n), "B64_01_Ret");
+    ASSERT_EQ(5, n, "B64_02_Len");
+    ASSERT_EQ(0, memcmp(buf, "Hello", 5), "B64_03_Val");
+}
+
+void test_B_unpadded_full(void) {
+    // Test: Length multiple of 4, no padding.
+    unsigned char buf[16] = {0};
+    size_t n = 0;
+    prepare_input("SGVsbG8gV29ybGQh");
+    ASSERT_EQ(1, my_scanf("%B", buf, &n), "B64_04_Ret");
+    ASSERT_EQ(12, n, "B64_05_Len");
+    ASSERT_EQ(0, memcmp(buf, "Hello World!", 12), "B64_06_Val");
+}
+
+void test_B_missing_padding(void) {
+    // Test: Unpadded tail of 3 and 2 sextets.
+    unsigned char a[8] = {0}, b[8] = {0};
+    size_t na = 0, nb = 0;
+    prepare_input("SGk SGVsbG8");
+    ASSERT_EQ(2, my_scanf("%B %B", a, &na, b, &nb), "B64_07_Ret");
+    ASSERT_EQ(2, na, "B64_08_LenA");
+    ASSERT_EQ(0, memcmp(a, "Hi", 2), "B64_09_ValA");
+    ASSERT_EQ(5, nb, "B64_10_LenB");
+}
+
+void test_B_binary_bytes(void) {
+    // Test: '+' and '/' map to high sextets.
+    unsigned char buf[4] = {0};
+    size_t n = 0;
+    prepare_input("/+8=");
+    ASSERT_EQ(1, my_scanf("%B", buf, &n), "B64_11_Ret");
+    ASSERT_EQ(2, n, "B64_12_Len");
+    ASSERT_EQ(0xFF, buf[0], "B64_13_B0");
+    ASSERT_EQ(0xEF, buf[1], "B64_14_B1");
+}
+
+void test_B_long_payload(void) {
+    // Test: 100 bytes span more than one internal block.
+    unsigned char buf[128] = {0};
+    size_t n = 0;
+    int ok = 1;
+    prepare_input("AAECAwQFBgcICQoLDA0ODxAREhMUFRYXGBkaGxwdHh8gISIjJCUmJygpKissLS4vMDEyMzQ1Njc4OTo7PD0+P0BBQkNERUZHSElKS0xNTk9QUVJTVFVWV1hZWltcXV5fYGFiYw==");
+    ASSERT_EQ(1, my_scanf("%B", buf, &n), "B64_15_Ret");
+    ASSERT_EQ(100, n, "B64_16_Len");
+    for (int i = 0; i < 100; i++) {
+        if (buf[i] != i) ok = 0;
+    }
+    ASSERT_EQ(1, ok, "B64_17_AllBytes");
+}
+
+void test_B_stopper_left(void) {
+    // Test: Stops at a non-alphabet character.
+    unsigned char buf[8] = {0};
+    size_t n = 0;
+    char next;
+    prepare_input("SGk=,next");
+    ASSERT_EQ(1, my_scanf("%B", buf, &n), "B64_18_Ret");
+    my_scanf("%c", &next);
+    ASSERT_EQ(',', next, "B64_19_Stopper");
+}
+
+void test_B_invalid(void) {
+    // Test: A lone trailing sextet and a broken "==" fail.
+    unsigned char buf[8] = {0};
+    size_t n = 0;
+    prepare_input("SGVsb\n");
+    ASSERT_EQ(0, my_scanf("%B", buf, &n), "B64_20_OneLeft");
+    prepare_input("SG=x\n");
+    ASSERT_EQ(0, my_scanf("%B", buf, &n), "B64_21_HalfPad");
+    prepare_input("!!!\n");
+    ASSERT_EQ(0, my_scanf("%B", buf, &n), "B64_22_NoData");
+}
+
+void test_B_width(void) {
+    // Test: Width limits the characters consumed.
+    unsigned char buf[8] = {0};
+    size_t n = 0;
+    prepare_input("SGVsbG8gV29y");
+    ASSERT_EQ(1, my_scanf("%4B", buf, &n), "B64_23_Ret");
+    ASSERT_EQ(3, n, "B64_24_Len");
+    ASSERT_EQ(0, memcmp(buf, "Hel", 3), "B64_25_Val");
+}
+
+void test_B_suppressed(void) {
+    // Test: Suppression takes no arguments.
+    int x = 0;
+    prepare_input("SGVsbG8= 9");
+    ASSERT_EQ(1, my_scanf("%*B %d", &x), "B64_26_Suppress");
+    ASSERT_EQ(9, x, "B64_27_Val");
+}
+
+// Helper: Base64-encodes n bytes of 'in' with padding into 'out'.
+static size_t b64_encode(const unsigned char *in, size_t n, char *out) {
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t k = 0;
+    for (size_t i = 0; i < n; i += 3) {
+        unsigned v = (unsigned)in[i] << 16;
+        if (i + 1 < n) v |= (unsigned)in[i + 1] << 8;
+        if (i + 2 < n) v |= in[i + 2];
+        out[k++] = alphabet[(v >> 18) & 63];
+        out[k++] = alphabet[(v >> 12) & 63];
+        out[k++] = (i + 1 < n) ? alphabet[(v >> 6) & 63] : '=';
+        out[k++] = (i + 2 < n) ? alphabet[v & 63] : '=';
+    }
+    out[k] = '\0';
+    return k;
+}
+
+void test_B_memory_chunks(void) {
+    // Test: A long field on a memory source is decoded 16 characters at a
+    // time; every alphabet class and the result match the stdio path.
+    unsigned char raw[301], a[320], b[320];
+    char text[420];
+    size_t na = 0, nb = 0;
+    ScanSource src;
+
+    for (int i = 0; i < 301; i++) raw[i] = (unsigned char)(i * 7 + 3);
+    size_t len = b64_encode(raw, sizeof(raw), text);
+    strcpy(text + len, ",x");
+
+    prepare_input(text);
+    ASSERT_EQ(1, my_scanf("%B", a, &na), "B64_28_File");
+    my_scanf_source_memory(&src, text, strlen(text));
+    my_scanf_set_source(&src);
+    ASSERT_EQ(1, my_scanf("%B", b, &nb), "B64_29_Memory");
+    ASSERT_EQ(301, nb, "B64_30_Len");
+    ASSERT_EQ(0, memcmp(raw, b, sizeof(raw)), "B64_31_Val");
+    ASSERT_EQ(0, memcmp(a, b, sizeof(raw)), "B64_32_SameAsFile");
+    ASSERT_EQ(len, my_scanf_tell(), "B64_33_Stopper");
+    my_scanf_set_source(NULL);
+}
+
+void test_B_memory_stops(void) {
+    // Test: Width and a stopper inside a 16-character chunk end the field
+    // at the same place as the per-character loop.
+    const char *text = "QUJDREVGR0hJSktMTU5PUFFSU1RVVldYWVo "
+                       "QUJDREVGR0hJSktMTU5PUFFSU1RVVldYWVo! QUJDREVGR0hJSktMTU5PU?";
+    unsigned char buf[64] = {0};
+    size_t n = 0;
+    char next = 0;
+    ScanSource src;
+
+    my_scanf_source_memory(&src, text, strlen(text));
+    my_scanf_set_source(&src);
+    ASSERT_EQ(1, my_scanf("%18B%*s", buf, &n), "B64_34_Width");
+    ASSERT_EQ(13, n, "B64_35_WidthLen");
+    ASSERT_EQ(0, memcmp(buf, "ABCDEFGHIJKLM", 13), "B64_36_WidthVal");
+    ASSERT_EQ(2, my_scanf(" %B%c", buf, &n, &next), "B64_37_Stopper");
+    ASSERT_EQ(26, n, "B64_38_StopperLen");
+    ASSERT_EQ(0, memcmp(buf, "ABCDEFGHIJKLMNOPQRSTUVWXYZ", 26), "B64_39_StopperVal");
+    ASSERT_EQ('!', next, "B64_40_StopperChar");
+    ASSERT_EQ(0, my_scanf(" %B", buf, &n), "B64_41_OneLeft");
+    ASSERT_EQ(1, my_scanf("%c", &next), "B64_42_Rest");
+    ASSERT_EQ('?', next, "B64_43_RestChar");
+    my_scanf_set_source(NULL);
+}
+
+void test_B_memory_suppressed(void) {
+    // Test: A suppressed long field on a memory source is skipped whole.
+    char text[200];
+    unsigned char raw[96];
+    int x = 0;
+    ScanSource src;
+
+    for (int i = 0; i < 96; i++) raw[i] = (unsigned char)(255 - i);
+    size_t len = b64_encode(raw, sizeof(raw), text);
+    strcpy(text + len, " 42");
+    my_scanf_source_memory(&src, text, strlen(text));
+    my_scanf_set_source(&src);
+    ASSERT_EQ(1, my_scanf("%*B %d", &x), "B64_44_Ret");
+    ASSERT_EQ(42, x, "B64_45_Val");
+    my_scanf_set_source(NULL);
+}
+
+void test_B_block_boundaries(void) {
+    // Test: A field split over many small blocks of a pipe decodes whole.
+    unsigned char raw[200], buf[208];
+    char text[300];
+    size_t n = 0;
+    ScanSource src;
+    int fds[2];
+
+    for (int i = 0; i < 200; i++) raw[i] = (unsigned char)(i ^ 0x5A);
+    size_t len = b64_encode(raw, sizeof(raw), text);
+    strcpy(text + len, ";");
+
+    ASSERT_EQ(0, pipe(fds), "B64_46_Pipe");
+    ASSERT_EQ((long)strlen(text), (long)write(fds[1], text, strlen(text)), "B64_47_Write");
+    close(fds[1]);
+    ASSERT_EQ(1, my_scanf_source_fd(&src, fds[0], 23), "B64_48_Open");
+    my_scanf_set_source(&src);
+    ASSERT_EQ(1, my_scanf("%B;", buf, &n), "B64_49_Ret");
+    ASSERT_EQ(200, n, "B64_50_Len");
+    ASSERT_EQ(0, memcmp(raw, buf, sizeof(raw)), "B64_51_Val");
+    ASSERT_EQ(len + 1, my_scanf_tell(), "B64_52_Offset");
+    my_scanf_set_source(NULL);
+    my_scanf_source_close(&src);
+    close(fds[0]);
+}
+
+/* =========================================================================
+ * BIGNUM TESTS (%Z) - Custom Specifier
+ * ========================================================================= */
+
+// Helper: Writes 2^n (or 2^n - 1) in decimal into 'out'.
+static void pow2_decimal(char *out, int n, int minus_one) {
+    static uint32_t d[2048];  // base 10^9, least significant first
+    int len = 1;
+    d[0] = 1;
+    for (int i = 0; i < n; i++) {
+        uint32_t carry = 0;
+        for (int j = 0; j < len; j++) {
+            uint32_t v = d[j] * 2 + carry;
+            carry = v >= 1000000000u;
+            d[j] = carry ? v - 1000000000u : v;
+        }
+        if (carry) d[len++] = 1;
+    }
+    if (minus_one) d[0]--;  // 2^n never ends in 0 (n > 0)
+    out += sprintf(out, "%u", d[len - 1]);
+    for (int j = len - 2; j >= 0; j--) out += sprintf(out, "%09u", d[j]);
+}
+
+void test_Z_small(void) {
+    // Test: Value spanning three limbs; fewer digits than two chunks.
+    uint64_t limbs[4] = {0};
+    BigInt z = {limbs, 4, 0, 0};
+    prepare_input("12345678901234567890123456789012345678901234567890");
+    ASSERT_EQ(1, my_scanf("%Z", &z), "Z01_Ret");
+    ASSERT_EQ(3, z.size, "Z02_Size");
+    ASSERT_EQ(0xf8c7f196ce3f0ad2ULL, limbs[0], "Z03_Limb0");
+    ASSERT_EQ(0xaaf83ca15026747aULL, limbs[1], "Z04_Limb1");
+    ASSERT_EQ(0x8727f6369ULL, limbs[2], "Z05_Limb2");
+    ASSERT_EQ(0, z.negative, "Z06_Sign");
+}
+
+void test_Z_sign_and_zero(void) {
+    // Test: Sign handling; zero (with leading zeros) has no limbs and no sign.
+    uint64_t a_l[2] = {0}, b_l[2] = {0};
+    BigInt a = {a_l, 2, 0, 0}, b = {b_l, 2, 9, 1};
+    prepare_input("-18446744073709551616 -0000000000000000000000000");
+    ASSERT_EQ(2, my_scanf("%Z %Z", &a, &b), "Z07_Ret");
+    ASSERT_EQ(2, a.size, "Z08_Size");
+    ASSERT_EQ(0ULL, a_l[0], "Z09_Lo");
+    ASSERT_EQ(1ULL, a_l[1], "Z10_Hi");
+    ASSERT_EQ(1, a.negative, "Z11_Neg");
+    ASSERT_EQ(0, b.size, "Z12_ZeroSize");
+    ASSERT_EQ(0, b.negative, "Z13_ZeroSign");
+}
+
+void test_Z_large_powers(void) {
+    // Test: 3600+ digits go through the divide-and-conquer and Karatsuba paths.
+    static char text[8192];
+    static uint64_t limbs[200];
+    BigInt z = {limbs, 200, 0, 0};
+    int bad = 0;
+
+    pow2_decimal(text, 12000, 0);   // 2^12000: only bit 12000 set
+    prepare_input(text);
+    ASSERT_EQ(1, my_scanf("%Z", &z), "Z14_Ret");
+    ASSERT_EQ(188, z.size, "Z15_Size");
+    for (int i = 0; i < 187; i++) bad |= (limbs[i] != 0);
+    ASSERT_EQ(0, bad, "Z16_LowZero");
+    ASSERT_EQ(1ULL << 32, limbs[187], "Z17_TopBit");
+
+    pow2_decimal(text, 12000, 1);   // 2^12000 - 1: all ones
+    prepare_input(text);
+    ASSERT_EQ(1, my_scanf("%Z", &z), "Z18_Ret");
+    ASSERT_EQ(188, z.size, "Z19_Size");
+    bad = 0;
+    for (int i = 0; i < 187; i++) bad |= (limbs[i] != ~0ULL);
+    ASSERT_EQ(0, bad, "Z20_AllOnes");
+    ASSERT_EQ((1ULL << 32) - 1, limbs[187], "Z21_Top");
+}
+
+void test_Z_capacity_width_suppress(void) {
+    // Test: Too few limbs fails; width splits digits; %*Z takes no argument.
+    uint64_t limbs[1] = {0};
+    BigInt z = {limbs, 1, 0, 0};
+    int x = 0;
+    prepare_input("18446744073709551616\n");
+    ASSERT_EQ(0, my_scanf("%Z", &z), "Z22_Capacity");
+
+    prepare_input("123456 99999999999999999999999999 7");
+    ASSERT_EQ(2, my_scanf("%3Z%*d %*Z %d", &z, &x), "Z23_Ret");
+    ASSERT_EQ(123ULL, limbs[0], "Z24_Width");
+    ASSERT_EQ(7, x, "Z25_Suppress");
+}
+
+/* =========================================================================
+ * SCANSET TESTS (%[...])
+ * ========================================================================= */
+
+void test_set_basic_range(void) {
+    // Test: Reads characters inside a range, stops at the first outsider.
+    char buf[16];
+    char next;
+    prepare_input("abc123");
+    ASSERT_EQ(1, my_scanf("%[a-z]", buf), "SC01_Ret");
+    ASSERT_STREQ("abc", buf, "SC02_Val");
+    my_scanf("%c", &next);
+    ASSERT_EQ('1', next, "SC03_Stopper");
+}
+
+void test_set_negated(void) {
+    // Test: %[^,] reads up to (not including) the comma.
+    char buf[16];
+    prepare_input("key=value,rest");
+    ASSERT_EQ(1, my_scanf("%[^,]", buf), "SC04_Ret");
+    ASSERT_STREQ("key=value", buf, "SC05_Val");
+}
+
+void test_set_csv_fields(void) {
+    // Test: Typical CSV line split with negated sets and literals.
+    char a[16], b[16], c[16];
+    prepare_input("alpha,beta gamma,delta\n");
+    ASSERT_EQ(3, my_scanf("%[^,],%[^,],%[^\n]", a, b, c), "SC06_Ret");
+    ASSERT_STREQ("alpha", a, "SC07_A");
+    ASSERT_STREQ("beta gamma", b, "SC08_B");
+    ASSERT_STREQ("delta", c, "SC09_C");
+}
+
+void test_set_key_value(void) {
+    // Test: key=value pair.
+    char key[16], val[16];
+    prepare_input("user=root");
+    ASSERT_EQ(2, my_scanf("%[^=]=%s", key, val), "SC10_Ret");
+    ASSERT_STREQ("user", key, "SC11_Key");
+    ASSERT_STREQ("root", val, "SC12_Val");
+}
+
+void test_set_no_whitespace_skip(void) {
+    // Test: Like %c, a scanset does NOT skip leading whitespace.
+    char buf[16];
+    prepare_input("  abc");
+    ASSERT_EQ(0, my_scanf("%[a-z]", buf), "SC13_NoSkip");
+}
+
+void test_set_empty_match_fail(void) {
+    // Test: Zero matching characters is a failure.
+    char buf[16];
+    prepare_input("123");
+    ASSERT_EQ(0, my_scanf("%[a-z]", buf), "SC14_EmptyFail");
+}
+
+void test_set_width(void) {
+    // Test: Width limits the number of characters stored.
+    char buf[16];
+    prepare_input("abcdef");
+    ASSERT_EQ(1, my_scanf("%3[a-z]", buf), "SC15_Ret");
+    ASSERT_STREQ("abc", buf, "SC16_Val");
+}
+
+void test_set_bracket_member(void) {
+    // Test: ']' right after '[' is a literal member.
+    char buf[16];
+    prepare_input("]]x");
+    ASSERT_EQ(1, my_scanf("%[]]", buf), "SC17_Ret");
+    ASSERT_STREQ("]]", buf, "SC18_Val");
+}
+
+void test_set_literal_dash(void) {
+    // Test: A trailing '-' is a literal member.
+    char buf[16];
+    prepare_input("12-34 x");
+    ASSERT_EQ(1, my_scanf("%[0-9-]", buf), "SC19_Ret");
+    ASSERT_STREQ("12-34", buf, "SC20_Val");
+}
+
+void test_set_suppressed(void) {
+    // Test: Suppression consumes the run without counting.
+    int x = 0;
+    prepare_input("header:42");
+    ASSERT_EQ(1, my_scanf("%*[^:]:%d", &x), "SC21_Ret");
+    ASSERT_EQ(42, x, "SC22_Val");
+}
+
+void test_set_eof_fail(void) {
+    // Test: Empty input returns EOF.
+    char buf[16];
+    prepare_input("");
+    ASSERT_EQ(EOF, my_scanf("%[a-z]", buf), "SC23_EOF");
+}
+
+void test_set_memory_runs(void) {
+    // Test: Long runs on a memory source are measured 16 bytes at a
+    // time; the stopper, width and result match the stdio path.
+    const char *text = "abcdefghijklmnopqrstuvwxyzabcdefghij,k0123456789012345678901234567890123456789xyz";
+    char a[64], b[64], c[64], d[64];
+    ScanSource src;
+
+    prepare_input(text);
+    ASSERT_EQ(3, my_scanf("%[a-z],%40[a-z0-9]%[^\n]", a, b, c), "SC24_File");
+    my_scanf_source_memory(&src, text, strlen(text));
+    my_scanf_set_source(&src);
+    ASSERT_EQ(3, my_scanf("%[a-z],%40[a-z0-9]%[^\n]", d, b, c), "SC25_Memory");
+    ASSERT_STREQ(a, d, "SC26_SameRun");
+    ASSERT_EQ(36, (long)strlen(d), "SC27_Stopper");
+    ASSERT_EQ(40, (long)strlen(b), "SC28_Width");
+    ASSERT_STREQ("9xyz", c, "SC29_Rest");
+    ASSERT_EQ(strlen(text), my_scanf_tell(), "SC30_End");
+    my_scanf_set_source(NULL);
+}
+
+void test_set_memory_many_ranges(void) {
+    // Test: A set with more ranges than the SIMD matcher keeps falls back
+    // to the bitmap; reaching the end of a buffer is not a failure.
+    const char *text = "a1c3e5g7i9kAmBoCqDsEuF";
+    char buf[32];
+    ScanSource src;
+
+    my_scanf_source_memory(&src, text, strlen(text));
+    my_scanf_set_source(&src);
+    ASSERT_EQ(1, my_scanf("%[acegikmoqsu0-9A-F]", buf), "SC31_Ret");
+    ASSERT_STREQ(text, buf, "SC32_Val");
+    ASSERT_EQ(EOF, my_scanf("%[a-z]", buf), "SC33_EOF");
+    my_scanf_set_source(NULL);
+}
+
+void test_set_cached_directive(void) {
+    // Test: A format buffer reused with a different set is recompiled.
+    char fmt[16];
+    char buf[16];
+
+    strcpy(fmt, "%[a-c]");
+    prepare_input("abcdef");
+    ASSERT_EQ(1, my_scanf(fmt, buf), "SC34_First");
+    ASSERT_STREQ("abc", buf, "SC35_FirstVal");
+    strcpy(fmt, "%[d-e]");
+    ASSERT_EQ(1, my_scanf(fmt, buf), "SC36_Second");
+    ASSERT_STREQ("de", buf, "SC37_SecondVal");
+    strcpy(fmt, "%[^");
+    ASSERT_EQ(0, my_scanf(fmt, buf), "SC38_Unterminated");
+}
+
+void test_set_block_boundaries(void) {
+    // Test: A run split over several tiny blocks of a pipe is read whole.
+    const char *text = "aaaaaaaaaaaaaaaaaaaaaaab:rest";
+    char buf[32];
+    ScanSource src;
+    int fds[2];
+
+    ASSERT_EQ(0, pipe(fds), "SC39_Pipe");
+    ASSERT_EQ((long)strlen(text), (long)write(fds[1], text, strlen(text)), "SC40_Write");
+    close(fds[1]);
+    ASSERT_EQ(1, my_scanf_source_fd(&src, fds[0], 5), "SC41_Open");
+    my_scanf_set_source(&src);
+    ASSERT_EQ(1, my_scanf("%[ab]:", buf), "SC42_Ret");
+    ASSERT_STREQ("aaaaaaaaaaaaaaaaaaaaaaab", buf, "SC43_Val");
+    ASSERT_EQ(25, my_scanf_tell(), "SC44_Offset");
+    my_scanf_set_source(NULL);
+    my_scanf_source_close(&src);
+    close(fds[0]);
+}
+
+/* =========================================================================
+ * BULK COLOR TESTS (my_scanf_colors)
+ * ========================================================================= */
+
+void test_bulk_rgb_basic(void) {
+    // Test: Three colors into a packed RGB array.
+    const char *text = "#FF0000 #00ff00\n#0000FF";
+    uint8_t px[9] = {0};
+    size_t fail = 99;
+    ASSERT_EQ(3, my_scanf_colors(text, strlen(text), px, 3, 3, &fail), "BK01_Count");
+    ASSERT_EQ(255, px[0], "BK02_R");
+    ASSERT_EQ(255, px[4], "BK03_G");
+    ASSERT_EQ(255, px[8], "BK04_B");
+    ASSERT_EQ(0, px[1] + px[2] + px[3] + px[5] + px[6] + px[7], "BK05_Zeros");
+    ASSERT_EQ(strlen(text), fail, "BK06_End");
+}
+
+void test_bulk_rgba_alpha(void) {
+    // Test: 4 channels; alpha defaults to 255 or comes from #RRGGBBAA.
+    const char *text = "#102030 #40506070";
+    uint8_t px[8] = {0};
+    ASSERT_EQ(2, my_scanf_colors(text, strlen(text), px, 2, 4, NULL), "BK07_Count");
+    ASSERT_EQ(0x10, px[0], "BK08_R");
+    ASSERT_EQ(255, px[3], "BK09_DefaultAlpha");
+    ASSERT_EQ(0x40, px[4], "BK10_R2");
+    ASSERT_EQ(0x70, px[7], "BK11_Alpha");
+}
+
+void test_bulk_fail_offset(void) {
+    // Test: Stops at the first malformed token and reports its offset.
+    const char *text = "#AABBCC #12G456 #000000";
+    uint8_t px[9] = {0};
+    size_t fail = 0;
+    ASSERT_EQ(1, my_scanf_colors(text, strlen(text), px, 3, 3, &fail), "BK12_Count");
+    ASSERT_EQ(8, fail, "BK13_Offset");
+}
+
+void test_bulk_bad_terminator(void) {
+    // Test: A token glued to other text is malformed.
+    const char *text = "#AABBCCx";
+    uint8_t px[3] = {0};
+    size_t fail = 99;
+    ASSERT_EQ(0, my_scanf_colors(text, strlen(text), px, 1, 3, &fail), "BK14_Count");
+    ASSERT_EQ(0, fail, "BK15_Offset");
+}
+
+void test_bulk_max_colors(void) {
+    // Test: Capacity limit; the offset points at the next token.
+    const char *text = "#111111 #222222 #333333";
+    uint8_t px[6] = {0};
+    size_t fail = 0;
+    ASSERT_EQ(2, my_scanf_colors(text, strlen(text), px, 2, 3, &fail), "BK16_Count");
+    ASSERT_EQ(15, fail, "BK17_Offset");
+    ASSERT_EQ(0x22, px[5], "BK18_Last");
+}
+
+void test_bulk_unterminated_tail(void) {
+    // Test: Buffer is not null-terminated and ends mid-token.
+    char text[10];
+    uint8_t px[6] = {0};
+    size_t fail = 0;
+    memcpy(text, "#ABCDEF #1", 10);
+    ASSERT_EQ(1, my_scanf_colors(text, 7, px, 2, 3, &fail), "BK19_ExactEnd");
+    ASSERT_EQ(0xEF, px[2], "BK20_Val");
+    ASSERT_EQ(1, my_scanf_colors(text, 10, px, 2, 3, &fail), "BK21_ShortTail");
+    ASSERT_EQ(8, fail, "BK22_Offset");
+}
+
+/* =========================================================================
+ * INPUT SOURCE TESTS (%n, my_scanf_source_*, my_scanf_tell)
+ * ========================================================================= */
+
+void test_n_basic(void) {
+    // Test: %n stores characters consumed so far and is not counted.
+    int a = 0, n1 = -1, n2 = -1;
+    prepare_input("  42 abc");
+    ASSERT_EQ(1, my_scanf("%d%n %*s%n", &a, &n1, &n2), "SRC01_Ret");
+    ASSERT_EQ(4, n1, "SRC02_AfterInt");
+    ASSERT_EQ(8, n2, "SRC03_AfterStr");
+}
+
+void test_n_modifiers(void) {
+    // Test: %n honors every length modifier; %*n stores nothing.
+    signed char hh = 0;
+    short h = 0;
+    long l = 0;
+    long long ll = 0;
+    size_t z = 0;
+    int x = 0;
+    prepare_input("12345");
+    ASSERT_EQ(1, my_scanf("%2d%hhn%hn%*n%ln%lln%zn", &x, &hh, &h, &l, &ll, &z), "SRC04_Ret");
+    ASSERT_EQ(2, hh, "SRC05_hh");
+    ASSERT_EQ(2, h, "SRC06_h");
+    ASSERT_EQ(2, l, "SRC07_l");
+    ASSERT_EQ(2, ll, "SRC08_ll");
+    ASSERT_EQ(2, z, "SRC09_z");
+}
+
+void test_source_memory_tell(void) {
+    // Test: Memory source; offsets slice records without rescanning.
+    const char *text = "10 alpha\n20 beta\n";
+    ScanSource src;
+    int id = 0;
+    size_t start, end;
+
+    my_scanf_source_memory(&src, text, strlen(text));
+    my_scanf_set_source(&src);
+    ASSERT_EQ(0, my_scanf_tell(), "SRC10_Start");
+    ASSERT_EQ(1, my_scanf("%d %*s", &id), "SRC11_Ret");
+    ASSERT_EQ(8, my_scanf_tell(), "SRC12_AfterRec1");
+    start = my_scanf_tell() + 1;
+    ASSERT_EQ(1, my_scanf("%d %*s", &id), "SRC13_Ret");
+    end = my_scanf_tell();
+    ASSERT_EQ(0, strncmp(text + start, "20 beta", end - start), "SRC14_Slice");
+    ASSERT_EQ(EOF, my_scanf("%d", &id), "SRC15_Eof");
+    ASSERT_EQ(strlen(text), my_scanf_tell(), "SRC16_End");
+    my_scanf_set_source(NULL);
+}
+
+void test_source_memory_unterminated(void) {
+    // Test: The buffer length bounds the read; pushback stays in bounds.
+    char text[6];
+    ScanSource src;
+    int a = 0, b = 0;
+
+    memcpy(text, "7 8999", 6);
+    my_scanf_source_memory(&src, text, 3);
+    my_scanf_set_source(&src);
+    ASSERT_EQ(2, my_scanf("%d %d", &a, &b), "SRC17_Ret");
+    ASSERT_EQ(8, b, "SRC18_Bounded");
+    ASSERT_EQ(3, my_scanf_tell(), "SRC19_Tell");
+    my_scanf_set_source(NULL);
+}
+
+void test_source_file_and_back(void) {
+    // Test: File source counts from its start; NULL restores stdin.
+    FILE *fp = fopen("test_source.tmp", "w");
+    ScanSource src;
+    int a = 0, b = 0;
+
+    fputs("#FF0000 5", fp);
+    fclose(fp);
+    fp = fopen("test_source.tmp", "r");
+    my_scanf_source_file(&src, fp);
+    my_scanf_set_source(&src);
+    prepare_input("6");
+    ASSERT_EQ(1, my_scanf("%*R %d", &a), "SRC20_Ret");
+    ASSERT_EQ(5, a, "SRC21_FromFile");
+    ASSERT_EQ(9, my_scanf_tell(), "SRC22_Tell");
+    my_scanf_set_source(NULL);
+    ASSERT_EQ(1, my_scanf("%d", &b), "SRC23_Stdin");
+    ASSERT_EQ(6, b, "SRC24_Val");
+    fclose(fp);
+    remove("test_source.tmp");
+}
+
+void test_source_pipelined(void) {
+    // Test: Tiny blocks force every field (and %D's lookahead) across
+    // block boundaries; results and offsets match a memory source.
+    const char *text = "1 2.5 01/02/2024 alpha\n-22 1e3 29/02/2024 beta\n333 0x1p4 31/12/1999 gamma\n";
+    ScanSource pipe_src, mem_src;
+    int fds[2];
+    int id[2];
+    double val[2];
+    Date date[2];
+    char name[2][8];
+    int same = 1, rows = 0;
+
+    ASSERT_EQ(0, pipe(fds), "SRC25_Pipe");
+    ASSERT_EQ((long)strlen(text), (long)write(fds[1], text, strlen(text)), "SRC26_Write");
+    close(fds[1]);
+
+    ASSERT_EQ(1, my_scanf_source_pipelined(&pipe_src, fds[0], 5, 3), "SRC27_Open");
+    my_scanf_source_memory(&mem_src, text, strlen(text));
+    for (;;) {
+        my_scanf_set_source(&pipe_src);
+        int r0 = my_scanf("%d %lf %D %7s", &id[0], &val[0], &date[0], name[0]);
+        size_t at0 = my_scanf_tell();
+        my_scanf_set_source(&mem_src);
+        int r1 = my_scanf("%d %lf %D %7s", &id[1], &val[1], &date[1], name[1]);
+        size_t at1 = my_scanf_tell();
+
+        same &= (r0 == r1) && (at0 == at1);
+        if (r0 != 4 || r1 != 4) break;
+        same &= (id[0] == id[1]) && (val[0] == val[1]) && (date[0].year == date[1].year) &&
+                (strcmp(name[0], name[1]) == 0);
+        rows++;
+    }
+    my_scanf_set_source(NULL);
+    ASSERT_EQ(3, rows, "SRC28_Rows");
+    ASSERT_EQ(1, same, "SRC29_SameAsMemory");
+    ASSERT_EQ(strlen(text), pipe_src.pos, "SRC30_Offset");
+    my_scanf_source_close(&pipe_src);
+    close(fds[0]);
+}
+
+void test_source_pipelined_early_close(void) {
+    // Test: Closing while the reader is blocked on an open pipe returns.
+    ScanSource src;
+    int fds[2];
+    int a = 0, b = 0;
+
+    ASSERT_EQ(0, pipe(fds), "SRC31_Pipe");
+    ASSERT_EQ(6, (long)write(fds[1], "7 8 9 ", 6), "SRC32_Write");
+    ASSERT_EQ(1, my_scanf_source_pipelined(&src, fds[0], 0, 2), "SRC33_Open");
+    my_scanf_set_source(&src);
+    ASSERT_EQ(2, my_scanf("%d %d", &a, &b), "SRC34_Partial");
+    my_scanf_set_source(NULL);
+    ASSERT_EQ(8, b, "SRC35_Val");
+    my_scanf_source_close(&src);
+    ASSERT_EQ(1, src.ctx == NULL, "SRC36_Closed");
+    close(fds[0]);
+    close(fds[1]);
+}
+
+void test_source_pipelined_waits(void) {
+    // Test: Both sides sleep instead of spinning: the parser waits for a
+    // late writer, and close stops a reader parked on a full ring.
+    ScanSource src;
+    int fds[2];
+    int a = 0, b = 0;
+    char big[4096];
+
+    ASSERT_EQ(0, pipe(fds), "SRC66_Pipe");
+    pid_t child = fork();
+    if (child == 0) {
+        usleep(100000);  // Long past the spin: the parser is asleep by now
+        if (write(fds[1], "41 42\n", 6) != 6) _exit(1);
+        _exit(0);
+    }
+    close(fds[1]);
+    alarm(5);  // A lost wakeup blocks here; fail loudly instead of hanging
+    ASSERT_EQ(1, my_scanf_source_pipelined(&src, fds[0], 0, 2), "SRC67_Open");
+    my_scanf_set_source(&src);
+    ASSERT_EQ(2, my_scanf("%d %d", &a, &b), "SRC68_LateWriter");
+    ASSERT_EQ(42, b, "SRC69_Val");
+    ASSERT_EQ(EOF, my_scanf("%d", &a), "SRC70_EofAfterWriter");
+    my_scanf_set_source(NULL);
+    my_scanf_source_close(&src);
+    alarm(0);
+    close(fds[0]);
+    while (child > 0 && waitpid(child, NULL, 0) < 0) {}
+
+    // 16-byte blocks, two in the ring: the reader fills both and sleeps
+    memset(big, ' ', sizeof big);
+    big[0] = '5';
+    ASSERT_EQ(0, pipe(fds), "SRC71_Pipe");
+    ASSERT_EQ((long)sizeof big, (long)write(fds[1], big, sizeof big), "SRC72_Write");
+    alarm(5);
+    ASSERT_EQ(1, my_scanf_source_pipelined(&src, fds[0], 16, 2), "SRC73_Open");
+    my_scanf_set_source(&src);
+    ASSERT_EQ(1, my_scanf("%d", &a), "SRC74_First");
+    my_scanf_set_source(NULL);
+    usleep(20000);
+    my_scanf_source_close(&src);
+    alarm(0);
+    ASSERT_EQ(1, src.ctx == NULL, "SRC75_ClosedFullRing");
+    close(fds[0]);
+    close(fds[1]);
+}
+
+void test_source_uring(void) {
+    // Test: Tiny blocks cycle through the ring many times; reading starts
+    // at the descriptor's offset and matches a memory source.
+    const char *text = "XYZ1 2.5 01/02/2024 alpha\n-22 1e3 29/02/2024 beta\n333 0x1p4 31/12/1999 gamma\n";
+    const char *body = text + 3;
+    ScanSource file_src, mem_src;
+    FILE *fp = tmpfile();
+    int id[2];
+    double val[2];
+    Date date[2];
+    char name[2][8];
+    int same = 1, rows = 0;
+
+    ASSERT_EQ(1, fp != NULL, "SRC37_Tmpfile");
+    if (fp == NULL) return;
+    fputs(text, fp);
+    fflush(fp);
+    lseek(fileno(fp), 3, SEEK_SET);
+
+    ASSERT_EQ(1, my_scanf_source_uring(&file_src, fileno(fp), 5, 3) >= 1, "SRC38_Open");
+    my_scanf_source_memory(&mem_src, body, strlen(body));
+    for (;;) {
+        my_scanf_set_source(&file_src);
+        int r0 = my_scanf("%d %lf %D %7s", &id[0], &val[0], &date[0], name[0]);
+        size_t at0 = my_scanf_tell();
+        my_scanf_set_source(&mem_src);
+        int r1 = my_scanf("%d %lf %D %7s", &id[1], &val[1], &date[1], name[1]);
+        size_t at1 = my_scanf_tell();
+
+        same &= (r0 == r1) && (at0 == at1);
+        if (r0 != 4 || r1 != 4) break;
+        same &= (id[0] == id[1]) && (val[0] == val[1]) && (date[0].year == date[1].year) &&
+                (strcmp(name[0], name[1]) == 0);
+        rows++;
+    }
+    my_scanf_set_source(NULL);
+    ASSERT_EQ(3, rows, "SRC39_Rows");
+    ASSERT_EQ(1, same, "SRC40_SameAsMemory");
+    ASSERT_EQ(strlen(body), file_src.pos, "SRC41_Offset");
+    ASSERT_EQ(3, (long)lseek(fileno(fp), 0, SEEK_CUR), "SRC42_FdOffsetKept");
+    my_scanf_source_close(&file_src);
+    ASSERT_EQ(1, file_src.ctx == NULL, "SRC43_Closed");
+    fclose(fp);
+}
+
+void test_source_uring_batch(void) {
+    // Test: A file that ends exactly on a block boundary, read by batch;
+    // a pipe cannot seek and is refused.
+    const char *text = "10 20\n30 40\n";  // 12 bytes: three 4-byte blocks
+    int a[4] = {0}, b[4] = {0};
+    void *cols[] = {a, b};
+    size_t strides[] = {sizeof(int), sizeof(int)};
+    ScanSource src;
+    FILE *fp = tmpfile();
+    size_t fail = 0;
+    int fds[2];
+
+    ASSERT_EQ(1, fp != NULL, "SRC44_Tmpfile");
+    if (fp == NULL) return;
+    fputs(text, fp);
+    fflush(fp);
+    rewind(fp);
+
+    ASSERT_EQ(1, my_scanf_source_uring(&src, fileno(fp), 4, 2) >= 1, "SRC45_Open");
+    ASSERT_EQ(2, my_scanf_batch("%d %d", &src, 4, cols, strides, &fail), "SRC46_Rows");
+    ASSERT_EQ(strlen(text), fail, "SRC47_End");
+    ASSERT_EQ(40, b[1], "SRC48_Val");
+    my_scanf_source_close(&src);
+    fclose(fp);
+
+    ASSERT_EQ(0, pipe(fds), "SRC49_Pipe");
+    ASSERT_EQ(0, my_scanf_source_uring(&src, fds[0], 0, 4), "SRC50_PipeRefused");
+    close(fds[0]);
+    close(fds[1]);
+}
+
+// Helper: Descriptor of this process's io_uring instance, or -1.
+static int find_uring_fd(void) {
+    char path[64], target[64];
+    for (int fd = 3; fd < 1024; fd++) {
+        snprintf(path, sizeof path, "/proc/self/fd/%d", fd);
+        ssize_t n = readlink(path, target, sizeof target - 1);
+        if (n <= 0) continue;
+        target[n] = '\0';
+        if (strcmp(target, "anon_inode:[io_uring]") == 0) return fd;
+    }
+    return -1;
+}
+
+void test_source_uring_enter_fails(void) {
+    // Test: io_uring_enter() starts failing with reads still queued; the
+    // rest of the file comes through pread() and close waits them out.
+    int n = 20000, bad = 0;
+    int *ids = malloc(n * sizeof(int));
+    void *cols[] = {ids};
+    size_t strides[] = {sizeof(int)};
+    ScanSource src;
+    FILE *fp = tmpfile();
+    size_t fail = 0;
+    int ring = -1, kind;
+
+    ASSERT_EQ(1, fp != NULL, "SRC76_Tmpfile");
+    if (fp == NULL) return;
+    for (int i = 0; i < n; i++) fprintf(fp, "%d\n", i);
+    fflush(fp);
+    rewind(fp);
+
+    kind = my_scanf_source_uring(&src, fileno(fp), 4096, 4);
+    ASSERT_EQ(1, kind >= 1, "SRC77_Open");
+    ASSERT_EQ(1000, my_scanf_batch("%d", &src, 1000, cols, strides, &fail), "SRC78_Head");
+    if (kind == 2) ring = find_uring_fd();
+    if (ring >= 0) {
+        // The ring stays alive through its mappings; only enter() fails
+        int null_fd = open("/dev/null", O_RDONLY);
+        ASSERT_EQ(ring, dup2(null_fd, ring), "SRC79_BreakRing");
+        close(null_fd);
+    }
+    cols[0] = ids + 1000;
+    ASSERT_EQ(n - 1000, my_scanf_batch("%d", &src, n, cols, strides, &fail), "SRC80_Rest");
+    for (int i = 0; i < n; i++) bad |= (ids[i] != i);
+    ASSERT_EQ(0, bad, "SRC81_NoFakeEof");
+    my_scanf_source_close(&src);
+    ASSERT_EQ(1, src.ctx == NULL, "SRC82_Closed");
+    fclose(fp);
+    free(ids);
+}
+
+void test_source_fd(void) {
+    // Test: Tiny blocks on a pipe match a memory source field for field.
+    const char *text = "1 2.5 01/02/2024 alpha\n-22 1e3 29/02/2024 beta\n333 0x1p4 31/12/1999 gamma\n";
+    ScanSource fd_src, mem_src;
+    int fds[2];
+    int id[2];
+    double val[2];
+    Date date[2];
+    char name[2][8];
+    int same = 1, rows = 0;
+
+    ASSERT_EQ(0, pipe(fds), "SRC51_Pipe");
+    ASSERT_EQ((long)strlen(text), (long)write(fds[1], text, strlen(text)), "SRC52_Write");
+    close(fds[1]);
+
+    ASSERT_EQ(1, my_scanf_source_fd(&fd_src, fds[0], 5), "SRC53_Open");
+    my_scanf_source_memory(&mem_src, text, strlen(text));
+    for (;;) {
+        my_scanf_set_source(&fd_src);
+        int r0 = my_scanf("%d %lf %D %7s", &id[0], &val[0], &date[0], name[0]);
+        size_t at0 = my_scanf_tell();
+        my_scanf_set_source(&mem_src);
+        int r1 = my_scanf("%d %lf %D %7s", &id[1], &val[1], &date[1], name[1]);
+        size_t at1 = my_scanf_tell();
+
+        same &= (r0 == r1) && (at0 == at1);
+        if (r0 != 4 || r1 != 4) break;
+        same &= (id[0] == id[1]) && (val[0] == val[1]) && (date[0].year == date[1].year) &&
+                (strcmp(name[0], name[1]) == 0);
+        rows++;
+    }
+    my_scanf_set_source(NULL);
+    ASSERT_EQ(3, rows, "SRC54_Rows");
+    ASSERT_EQ(1, same, "SRC55_SameAsMemory");
+    ASSERT_EQ(strlen(text), fd_src.pos, "SRC56_Offset");
+    my_scanf_source_close(&fd_src);
+    ASSERT_EQ(1, fd_src.ctx == NULL, "SRC57_Closed");
+    close(fds[0]);
+}
+
+void test_source_fd_pipe_size(void) {
+    // Test: The pipe is enlarged, and one refill gathers every waiting write.
+    ScanSource src;
+    int fds[2];
+    int a = 0, b = 0, c = 0;
+
+    ASSERT_EQ(0, pipe(fds), "SRC58_Pipe");
+    ASSERT_EQ(1, my_scanf_source_fd(&src, fds[0], 1u << 20), "SRC59_Open");
+#ifdef F_GETPIPE_SZ
+    ASSERT_EQ(1, fcntl(fds[0], F_GETPIPE_SZ) >= (1 << 17), "SRC60_Grown");
+#endif
+    ASSERT_EQ(4, (long)write(fds[1], "10 2", 4), "SRC61_Write");
+    ASSERT_EQ(4, (long)write(fds[1], "0 30", 4), "SRC62_Write");
+    close(fds[1]);
+
+    my_scanf_set_source(&src);
+    ASSERT_EQ(3, my_scanf("%d %d %d", &a, &b, &c), "SRC63_Read");
+    my_scanf_set_source(NULL);
+    ASSERT_EQ(20, b, "SRC64_Split");
+    ASSERT_EQ(8, (long)src.len, "SRC65_OneBlock");
+    my_scanf_source_close(&src);
+    close(fds[0]);
+}
+
+/* =========================================================================
+ * BATCH TESTS (my_scanf_batch)
+ * ========================================================================= */
+
+void test_batch_columns(void) {
+    // Test: Three records into struct-of-arrays columns.
+    const char *text = "1 2.5 01/02/2024\n2 -1 29/02/2024\n3 1e3 31/12/1999\n";
+    int ids[4] = {0};
+    double vals[4] = {0};
+    Date dates[4];
+    void *cols[] = {ids, vals, dates};
+    size_t strides[] = {sizeof(int), sizeof(double), sizeof(Date)};
+    ScanSource src;
+    size_t fail = 0;
+
+    my_scanf_source_memory(&src, text, strlen(text));
+    ASSERT_EQ(3, my_scanf_batch("%d %lf %D", &src, 10, cols, strides, &fail), "BT01_Rows");
+    ASSERT_EQ(strlen(text), fail, "BT02_End");
+    ASSERT_EQ(3, ids[2], "BT03_Id");
+    ASSERT_DBL_NEAR(-1.0, vals[1], 0, "BT04_Val");
+    ASSERT_EQ(29, dates[1].day, "BT05_Date");
+    ASSERT_EQ(1999, dates[2].year, "BT06_Year");
+}
+
+void test_batch_failure_offset(void) {
+    // Test: Stops at the first bad record and reports where it starts.
+    const char *text = "1 2.5\n2 x\n3 1.0\n";
+    int ids[3] = {0};
+    double vals[3] = {0};
+    void *cols[] = {ids, vals};
+    size_t strides[] = {sizeof(int), sizeof(double)};
+    ScanSource src;
+    size_t fail = 0;
+
+    my_scanf_source_memory(&src, text, strlen(text));
+    ASSERT_EQ(1, my_scanf_batch("%d %lf", &src, 3, cols, strides, &fail), "BT07_Rows");
+    ASSERT_EQ(5, fail, "BT08_FailOffset");
+}
+
+void test_batch_strided_and_limit(void) {
+    // Test: Strides can address struct fields; n_max caps the rows.
+    struct { int a; char name[8]; } rows[2];
+    const char *text = "7 seven 8 eight 9 nine";
+    void *cols[] = {&rows[0].a, rows[0].name};
+    size_t strides[] = {sizeof rows[0], sizeof rows[0]};
+    ScanSource src;
+    size_t fail = 0;
+    int next = 0;
+
+    my_scanf_source_memory(&src, text, strlen(text));
+    ASSERT_EQ(2, my_scanf_batch("%d %7s", &src, 2, cols, strides, &fail), "BT09_Rows");
+    ASSERT_EQ(8, rows[1].a, "BT10_Field");
+    ASSERT_STREQ("eight", rows[1].name, "BT11_Name");
+    ASSERT_EQ(15, fail, "BT12_Stop");
+
+    // The source keeps its cursor for the caller
+    my_scanf_set_source(&src);
+    ASSERT_EQ(1, my_scanf("%d", &next), "BT13_Resume");
+    ASSERT_EQ(9, next, "BT14_Next");
+    my_scanf_set_source(NULL);
+}
+
+void test_batch_stdin(void) {
+    // Test: NULL source reads the active source (stdin here).
+    long long v[4] = {0};
+    void *cols[] = {v};
+    size_t strides[] = {sizeof v[0]};
+    prepare_input("10,20,30,");
+    ASSERT_EQ(3, my_scanf_batch("%lld,", NULL, 4, cols, strides, NULL), "BT15_Rows");
+    ASSERT_EQ(30, v[2], "BT16_Val");
+}
+
+/* =========================================================================
+ * VALIDATION TESTS (my_scanf_validate)
+ * ========================================================================= */
+
+void test_validate_counts(void) {
+    // Test: Counts matching records and stops at the first bad one.
+    const char *good = "1 2.5 01/02/2024\n-2 1e999999999 29/02/2024\n";
+    const char *bad_date = "1 2.5 01/02/2024\n2 3.5 30/02/2023\n3 1 01/01/2000\n";
+    const char *bad_num = "10 0x1F\n20 zz\n";
+    ScanSource src;
+    size_t fail = 0;
+
+    my_scanf_source_memory(&src, good, strlen(good));
+    ASSERT_EQ(2, my_scanf_validate("%d %lf %D", &src, &fail), "VAL01_Good");
+    ASSERT_EQ(strlen(good), fail, "VAL02_End");
+
+    my_scanf_source_memory(&src, bad_date, strlen(bad_date));
+    ASSERT_EQ(1, my_scanf_validate("%d %lf %D", &src, &fail), "VAL03_BadDate");
+    ASSERT_EQ(16, fail, "VAL04_BadDateOffset");
+
+    my_scanf_source_memory(&src, bad_num, strlen(bad_num));
+    ASSERT_EQ(1, my_scanf_validate("%u %x", &src, &fail), "VAL05_BadHex");
+    ASSERT_EQ(7, fail, "VAL06_BadHexOffset");
+}
+
+void test_validate_truncated_and_batch(void) {
+    // Test: A cut-off last record is an error; counts agree with the batch.
+    const char *cut = "1 2\n3";
+    const char *text = "5 a\n6 b\n7 c\n";
+    int ids[4];
+    char names[4][4];
+    void *cols[] = {ids, names};
+    size_t strides[] = {sizeof ids[0], sizeof names[0]};
+    ScanSource src;
+    size_t fail = 0, batch_fail = 0;
+
+    my_scanf_source_memory(&src, cut, strlen(cut));
+    ASSERT_EQ(1, my_scanf_validate("%d %d", &src, &fail), "VAL07_Truncated");
+    ASSERT_EQ(3, fail, "VAL08_TruncatedOffset");
+
+    my_scanf_source_memory(&src, text, strlen(text));
+    ASSERT_EQ(3, my_scanf_validate("%d %3s", &src, &fail), "VAL09_Count");
+    ASSERT_EQ(strlen(text), src.pos, "VAL10_SourceAdvanced");
+    ids[0] = -1;
+    my_scanf_source_memory(&src, text, strlen(text));
+    ASSERT_EQ(3, my_scanf_batch("%d %3s", &src, 4, cols, strides, &batch_fail), "VAL11_Batch");
+    ASSERT_EQ(batch_fail, fail, "VAL12_SameStop");
+
+    // Nothing is written: no destinations are even consulted
+    prepare_input("42 43");
+    ASSERT_EQ(1, my_scanf_validate("%d %d", NULL, &fail), "VAL13_Stdin");
+}
+
+/* =========================================================================
+ * SCHEMA TESTS (my_scanf_records)
+ * ========================================================================= */
+
+typedef struct {
+    long long id;
+    short qty;
+    float price;
+    char name[8];
+    Date when;
+    uint32_t color;
+} SchemaRow;
+
+void test_records_basic(void) {
+    // Test: Sizes pick the length modifiers; strings are bounded by the field.
+    const ScanField fields[] = {
+        {"d", 0, offsetof(SchemaRow, id),    sizeof(long long)},
+        {"d", 0, offsetof(SchemaRow, qty),   sizeof(short)},
+        {"f", 0, offsetof(SchemaRow, price), sizeof(float)},
+        {"s", 0, offsetof(SchemaRow, name),  8},
+        {"D", 0, offsetof(SchemaRow, when),  sizeof(Date)},
+        {"R", 0, offsetof(SchemaRow, color), sizeof(uint32_t)},
+    };
+    const char *text = "9000000000 3 1.5 widget 01/03/2024 #FF8000\n"
+                       "7 -2 0.25 averylongname 31/12/2023 #000000\n";
+    SchemaRow rows[3];
+    ScanSource src;
+    size_t fail = 0;
+
+    my_scanf_source_memory(&src, text, strlen(text));
+    ASSERT_EQ(1, my_scanf_records(fields, 6, &src, rows, sizeof rows[0], 3, &fail), "SCH01_Rows");
+    ASSERT_EQ(9000000000LL, rows[0].id, "SCH02_Int64");
+    ASSERT_EQ(3, rows[0].qty, "SCH03_Short");
+    ASSERT_DBL_NEAR(1.5, rows[0].price, 0, "SCH04_Float");
+    ASSERT_STREQ("widget", rows[0].name, "SCH05_Name");
+    ASSERT_EQ(3, rows[0].when.month, "SCH06_Date");
+    ASSERT_EQ(0xFF8000FFu, rows[0].color, "SCH07_Packed");
+    // "averylongname" is cut at 7 chars, so the date field sees "name"
+    ASSERT_EQ(42, fail, "SCH08_FailOffset");
+}
+
+void test_records_many(void) {
+    // Test: Many records; days-since-epoch via a 4-byte date field.
+    typedef struct { int32_t day; unsigned char ip[4]; double v; } Row;
+    const ScanField fields[] = {
+        {"D", 0, offsetof(Row, day), sizeof(int32_t)},
+        {"N", 0, offsetof(Row, ip),  4},
+        {"f", 0, offsetof(Row, v),   sizeof(double)},
+    };
+    const char *text = "01/01/1970 10.0.0.1 0.5\n02/01/1970 10.0.0.2 1e300\n";
+    Row rows[4];
+    ScanSource src;
+    size_t fail = 0;
+
+    my_scanf_source_memory(&src, text, strlen(text));
+    ASSERT_EQ(2, my_scanf_records(fields, 3, &src, rows, sizeof rows[0], 4, &fail), "SCH09_Rows");
+    ASSERT_EQ(1, rows[1].day, "SCH10_Days");
+    ASSERT_EQ(2, rows[1].ip[3], "SCH11_Ip");
+    ASSERT_DBL_NEAR(1e300, rows[1].v, 1e285, "SCH12_Double");
+    ASSERT_EQ(strlen(text), fail, "SCH13_End");
+}
+
+void test_records_field_ops(void) {
+    // Test: Scansets, %n, %c, hex and timestamps run from the compiled schema
+    // and store what my_scanf_batch() stores for the same format.
+    typedef struct { char key[6]; unsigned char hex; int64_t ts; char tag; int used; } Row;
+    const ScanField fields[] = {
+        {"[a-z]", 0, offsetof(Row, key),  sizeof(((Row *)0)->key)},
+        {"x",     0, offsetof(Row, hex),  1},
+        {"T",     0, offsetof(Row, ts),   8},
+        {"c",     0, offsetof(Row, tag),  1},
+        {"n",     0, offsetof(Row, used), sizeof(int)},
+    };
+    const char *text = "alpha 1ff 1970-01-01T00:00:01Z A\n"
+                       "bravo 2a 1970-01-01T00:00:02.5Z B\n"
+                       "Upper 1 1970-01-01T00:00:00Z C\n";
+    Row rows[4];
+    char keys[4][6];
+    unsigned char hexes[4];
+    ScanSource src;
+    size_t fail = 0, batch_fail = 0;
+
+    my_scanf_source_memory(&src, text, strlen(text));
+    ASSERT_EQ(2, my_scanf_records(fields, 5, &src, rows, sizeof rows[0], 4, &fail), "SCH17_Rows");
+    ASSERT_STREQ("bravo", rows[1].key, "SCH18_Scanset");
+    ASSERT_EQ(0xFF, rows[0].hex, "SCH19_HexTruncated");
+    ASSERT_EQ(2500000000LL, rows[1].ts, "SCH20_Timestamp");
+    ASSERT_EQ('B', rows[1].tag, "SCH21_Char");
+    ASSERT_EQ(34, rows[1].used, "SCH22_Count");
+
+    void *cols[] = {keys, hexes};
+    size_t strides[] = {sizeof keys[0], 1};
+    my_scanf_source_memory(&src, text, strlen(text));
+    my_scanf_batch(" %5[a-z] %hhx %*T %*c %*n", &src, 4, cols, strides, &batch_fail);
+    ASSERT_EQ(batch_fail, fail, "SCH23_SameStop");
+
+    // A scanset must be the whole spec; text after ']' is not a literal
+    const ScanField trailing[] = {{"[a-z],", 0, offsetof(Row, key), sizeof(((Row *)0)->key)}};
+    const ScanField open_set[] = {{"[a-z", 0, offsetof(Row, key), sizeof(((Row *)0)->key)}};
+    my_scanf_source_memory(&src, text, strlen(text));
+    ASSERT_EQ(0, my_scanf_records(trailing, 1, &src, rows, sizeof rows[0], 1, &fail), "SCH24_ScansetTail");
+    ASSERT_EQ(0, my_scanf_records(open_set, 1, &src, rows, sizeof rows[0], 1, &fail), "SCH25_ScansetOpen");
+#ifdef __SIZEOF_INT128__
+    typedef struct { __int128 big; } Wide;
+    const ScanField wide[] = {{"d", 0, offsetof(Wide, big), 16}};
+    Wide w[1];
+    my_scanf_source_memory(&src, "-170141183460469231731687303715884105728", 40);
+    ASSERT_EQ(1, my_scanf_records(wide, 1, &src, w, sizeof w[0], 1, &fail), "SCH26_Int128");
+    ASSERT_EQ(1, (unsigned __int128)w[0].big == (unsigned __int128)1 << 127, "SCH27_Int128Min");
+#endif
+}
+
+void test_records_invalid_schema(void) {
+    // Test: A size no modifier can serve rejects the schema up front.
+    typedef struct { int a; char pad[3]; } Row;
+    const ScanField bad_size[] = {{"d", 0, offsetof(Row, pad), 3}};
+    const ScanField bad_width[] = {{"s", 10, offsetof(Row, pad), 3}};
+    Row rows[1];
+    ScanSource src;
+    size_t fail = 99;
+
+    my_scanf_source_memory(&src, "1", 1);
+    ASSERT_EQ(0, my_scanf_records(bad_size, 1, &src, rows, sizeof rows[0], 1, &fail), "SCH14_BadSize");
+    ASSERT_EQ(0, fail, "SCH15_Offset");
+    ASSERT_EQ(0, my_scanf_records(bad_width, 1, &src, rows, sizeof rows[0], 1, &fail), "SCH16_BadWidth");
+}
+
+/* =========================================================================
+ * STRUCTURAL INDEX TESTS (my_scanf_indexed)
+ * ========================================================================= */
+
+void test_indexed_columns(void) {
+    // Test: Every record comes from the index; results as my_scanf_batch().
+    const char *text = "1 2.5 one\n-22 -1 two\n333 1e3 three\n";
+    int ids[4] = {0};
+    double vals[4] = {0};
+    char names[4][8];
+    void *cols[] = {ids, vals, names};
+    size_t strides[] = {sizeof(int), sizeof(double), sizeof names[0]};
+    size_t fail = 0;
+    ScanStats st;
+
+    my_scanf_reset_stats();
+    ASSERT_EQ(3, my_scanf_indexed("%d %lf %7s", text, strlen(text), 10, cols, strides, &fail), "IX01_Rows");
+    ASSERT_EQ(strlen(text), fail, "IX02_End");
+    ASSERT_EQ(-22, ids[1], "IX03_Neg");
+    ASSERT_DBL_NEAR(1000.0, vals[2], 0, "IX04_Float");
+    ASSERT_STREQ("three", names[2], "IX05_Str");
+    my_scanf_get_stats(&st);
+    ASSERT_EQ(3, st.index_fast_records, "IX06_AllFast");
+}
+
+void test_indexed_literals(void) {
+    // Test: Literal delimiters; %s running over a ',' matches scanf exactly.
+    const char *text = "10,20; 30 ,40;";
+    const char *greedy = "ab,3 cd,4";
+    long long a[4] = {0}, b[4] = {0};
+    char words[4][8];
+    int nums[4] = {0};
+    void *cols[] = {a, b};
+    void *wcols[] = {words, nums};
+    size_t strides[] = {sizeof a[0], sizeof b[0]};
+    size_t wstrides[] = {sizeof words[0], sizeof nums[0]};
+    size_t fail = 0;
+
+    ASSERT_EQ(1, my_scanf_indexed("%lld,%lld;", text, strlen(text), 4, cols, strides, &fail), "IX07_Literal");
+    ASSERT_EQ(6, fail, "IX08_LiteralStop");
+    ASSERT_EQ(2, my_scanf_indexed("%lld ,%lld;", text, strlen(text), 4, cols, strides, &fail), "IX09_SpacedLiteral");
+    ASSERT_EQ(40, b[1], "IX10_Val");
+    // "%s" takes "ab,3", then ',' finds ' ': record 1 fails, as with scanf
+    ASSERT_EQ(0, my_scanf_indexed("%7s,%d", greedy, strlen(greedy), 4, wcols, wstrides, &fail), "IX11_Greedy");
+    ASSERT_STREQ("ab,3", words[0], "IX12_GreedyStr");
+}
+
+void test_indexed_fallback(void) {
+    // Test: Tokens the index cannot convert are re-run by the interpreter.
+    const char *text = "0x1f 12ab\n";
+    unsigned int hex[2] = {0};
+    int dec[2] = {0};
+    void *cols[] = {hex, dec};
+    size_t strides[] = {sizeof hex[0], sizeof dec[0]};
+    size_t fail = 0;
+    ScanStats st;
+
+    my_scanf_reset_stats();
+    ASSERT_EQ(1, my_scanf_indexed("%x %d", text, strlen(text), 2, cols, strides, &fail), "IX13_Rows");
+    ASSERT_EQ(0x1F, hex[0], "IX14_Hex");
+    ASSERT_EQ(12, dec[0], "IX15_Partial");
+    ASSERT_EQ(7, fail, "IX16_Stop");
+    my_scanf_get_stats(&st);
+    ASSERT_EQ(1, st.index_slow_records >= 1, "IX17_Slow");
+
+    // %c is not token-shaped: the whole call goes to my_scanf_batch()
+    char ch[2];
+    void *ccols[] = {ch};
+    size_t cstrides[] = {1};
+    ASSERT_EQ(2, my_scanf_indexed("%c", "xy", 2, 2, ccols, cstrides, &fail), "IX18_Delegated");
+    ASSERT_EQ('y', ch[1], "IX19_Char");
+}
+
+void test_indexed_windows(void) {
+    // Test: ~400 KB crosses many index windows; matches my_scanf_batch().
+    int n = 20000;
+    char *text = malloc((size_t)n * 24);
+    int *a = malloc(n * sizeof(int)), *b = malloc(n * sizeof(int));
+    char (*s1)[12] = calloc(n, sizeof *s1), (*s2)[12] = calloc(n, sizeof *s2);
+    size_t len = 0, fa = 0, fb = 0;
+    ScanSource src;
+
+    for (int i = 0; i < n; i++) len += sprintf(text + len, "%d word%d%s", i * 7919, i % 1000, (i % 3) ? " " : "\n");
+    void *ca[] = {a, s1}, *cb[] = {b, s2};
+    size_t strides[] = {sizeof(int), sizeof s1[0]};
+
+    my_scanf_source_memory(&src, text, len);
+    ASSERT_EQ(n, my_scanf_batch("%d %11s", &src, n, ca, strides, &fa), "IX20_BatchRows");
+    ASSERT_EQ(n, my_scanf_indexed("%d %11s", text, len, n, cb, strides, &fb), "IX21_IndexedRows");
+    ASSERT_EQ(fa, fb, "IX22_SameStop");
+    ASSERT_EQ(0, memcmp(a, b, n * sizeof(int)) || memcmp(s1, s2, n * sizeof *s1), "IX23_SameValues");
+
+    // A bad record half way: same count and offset
+    char *bad = strstr(text, " 118785000 ");  // Record 15000
+    bad[1] = '@';
+    my_scanf_source_memory(&src, text, len);
+    ASSERT_EQ(15000, my_scanf_batch("%d %11s", &src, n, ca, strides, &fa), "IX24_BatchFail");
+    ASSERT_EQ(15000, my_scanf_indexed("%d %11s", text, len, n, cb, strides, &fb), "IX25_IndexedFail");
+    ASSERT_EQ(fa, fb, "IX26_FailOffset");
+    free(text); free(a); free(b); free(s1); free(s2);
+}
+
+/* =========================================================================
+ * LAZY RECORD TESTS (my_scanf_lazy_*)
+ * ========================================================================= */
+
+void test_lazy_on_demand(void) {
+    // Test: Spans first, values only for the fields asked for, then cached.
+    const char *text = "7 2.5 01/02/2024\n8 x 29/02/2023\n";
+    LazyRecord r;
+    int id = 0;
+    double val = 0;
+    Date date;
+
+    ASSERT_EQ(1, my_scanf_lazy_open(&r, "%d %lf %D", text, strlen(text)), "LZ01_Open");
+    ASSERT_EQ(1, my_scanf_lazy_next(&r), "LZ02_Record");
+    ASSERT_EQ(3, r.nfields, "LZ03_Fields");
+    ASSERT_EQ(2, r.fields[1].offset, "LZ04_Offset");
+    ASSERT_EQ(3, r.fields[1].length, "LZ05_Length");
+    ASSERT_EQ('D', r.fields[2].spec, "LZ06_Spec");
+    ASSERT_EQ(0, r.fields[2].state, "LZ07_NotConverted");
+    ASSERT_EQ(1, my_scanf_lazy_get(&r, 2, &date), "LZ08_GetDate");
+    ASSERT_EQ(2024, date.year, "LZ09_Year");
+    ASSERT_EQ(1, r.fields[2].state, "LZ10_Cached");
+    date.year = 0;
+    ASSERT_EQ(1, my_scanf_lazy_get(&r, 2, &date), "LZ11_GetAgain");
+    ASSERT_EQ(2024, date.year, "LZ12_FromCache");
+
+    // Record 2: the bad fields fail on their own, the good one converts
+    ASSERT_EQ(1, my_scanf_lazy_next(&r), "LZ13_Record2");
+    ASSERT_EQ(16, r.record_start, "LZ14_RecordStart");
+    ASSERT_EQ(1, my_scanf_lazy_get(&r, 0, &id), "LZ15_GetId");
+    ASSERT_EQ(8, id, "LZ16_Id");
+    ASSERT_EQ(0, my_scanf_lazy_get(&r, 1, &val), "LZ17_BadFloat");
+    ASSERT_EQ(0, my_scanf_lazy_get(&r, 2, &date), "LZ18_BadDate");
+    ASSERT_EQ(0, my_scanf_lazy_get(&r, 3, &val), "LZ19_OutOfRange");
+    ASSERT_EQ(0, my_scanf_lazy_next(&r), "LZ20_End");
+    my_scanf_lazy_close(&r);
+}
+
+void test_lazy_literals_and_errors(void) {
+    // Test: Literal delimiters, whole-token rule, malformed records.
+    const char *text = "12ab,7f; 5,8;\n6;";
+    LazyRecord r;
+    unsigned int hex = 0;
+    int n = 0;
+
+    ASSERT_EQ(0, my_scanf_lazy_open(&r, "%d %c", text, strlen(text)), "LZ21_Unsupported");
+    ASSERT_EQ(1, my_scanf_lazy_open(&r, "%d,%x;", text, strlen(text)), "LZ22_Open");
+    ASSERT_EQ(1, my_scanf_lazy_next(&r), "LZ23_Record");
+    ASSERT_EQ(4, r.fields[0].length, "LZ24_Token");
+    ASSERT_EQ(0, my_scanf_lazy_get(&r, 0, &n), "LZ25_WholeToken");
+    ASSERT_EQ(1, my_scanf_lazy_get(&r, 1, &hex), "LZ26_Hex");
+    ASSERT_EQ(0x7f, hex, "LZ27_HexVal");
+    ASSERT_EQ(1, my_scanf_lazy_next(&r), "LZ28_Record2");
+    ASSERT_EQ(1, my_scanf_lazy_get(&r, 0, &n), "LZ29_Int");
+    ASSERT_EQ(5, n, "LZ30_IntVal");
+    ASSERT_EQ(-1, my_scanf_lazy_next(&r), "LZ31_Malformed");
+    ASSERT_EQ(13, r.pos, "LZ32_MalformedPos");
+    my_scanf_lazy_close(&r);
+}
+
+void test_lazy_strings(void) {
+    // Test: %s takes its whole whitespace-delimited token, as in my_scanf();
+    // with literals in the format the split would differ, so it is refused.
+    const char *text = "1 a,b\n2 c;d\n";
+    LazyRecord r;
+    char name[8];
+
+    ASSERT_EQ(0, my_scanf_lazy_open(&r, "%d,%7s;", text, strlen(text)), "LZ33_StrWithLiterals");
+    ASSERT_EQ(0, my_scanf_lazy_open(&r, "%7s,%d", text, strlen(text)), "LZ34_StrBeforeLiteral");
+    ASSERT_EQ(1, my_scanf_lazy_open(&r, "%d %7s", text, strlen(text)), "LZ35_Open");
+    ASSERT_EQ(1, my_scanf_lazy_next(&r), "LZ36_Record");
+    ASSERT_EQ(1, my_scanf_lazy_get(&r, 1, name), "LZ37_Str");
+    ASSERT_STREQ("a,b", name, "LZ38_WholeToken");
+    ASSERT_EQ(1, my_scanf_lazy_next(&r), "LZ39_Record2");
+    ASSERT_EQ(1, my_scanf_lazy_get(&r, 1, name), "LZ40_Str2");
+    ASSERT_STREQ("c;d", name, "LZ41_WholeToken2");
+    my_scanf_lazy_close(&r);
+}
+
+/* =========================================================================
+ * PARALLEL TESTS (my_scanf_parallel)
+ * ========================================================================= */
+
+// Helper: Builds 'n' lines "<i> <i/2>\n"; returns a malloc'd buffer.
+static char *make_lines(int n, size_t *len) {
+    char *text = malloc((size_t)n * 24 + 1);
+    size_t pos = 0;
+    for (int i = 0; i < n; i++) pos += sprintf(text + pos, "%d %d.5\n", i, i / 2);
+    *len = pos;
+    return text;
+}
+
+void test_parallel_order(void) {
+    // Test: 4 workers over ~300 KB; rows land in input order.
+    size_t len, fail = 0;
+    int n = 30000, bad = 0;
+    char *text = make_lines(n, &len);
+    int *ids = malloc(n * sizeof(int));
+    double *vals = malloc(n * sizeof(double));
+    void *cols[] = {ids, vals};
+    size_t strides[] = {sizeof(int), sizeof(double)};
+
+    ASSERT_EQ(n, my_scanf_parallel("%d %lf", text, len, n, cols, strides, 4, &fail), "PAR01_Rows");
+    // n_max rows: like my_scanf_batch(), stops before the last '\n'
+    ASSERT_EQ(len - 1, fail, "PAR02_End");
+    for (int i = 0; i < n; i++) bad |= (ids[i] != i) || (vals[i] != i / 2 + 0.5);
+    ASSERT_EQ(0, bad, "PAR03_Order");
+    free(text); free(ids); free(vals);
+}
+
+void test_parallel_failure_and_cap(void) {
+    // Test: A bad line late in the input stops the count there; n_max caps it.
+    size_t len, fail = 0;
+    int n = 30000;
+    char *text = make_lines(n, &len);
+    int *ids = malloc(n * sizeof(int));
+    double *vals = malloc(n * sizeof(double));
+    void *cols[] = {ids, vals};
+    size_t strides[] = {sizeof(int), sizeof(double)};
+    char *bad_line = strstr(text, "\n25000 ") + 1;
+
+    bad_line[0] = 'X';
+    ASSERT_EQ(25000, my_scanf_parallel("%d %lf", text, len, n, cols, strides, 4, &fail), "PAR04_Rows");
+    ASSERT_EQ((size_t)(bad_line - text) - 1, fail, "PAR05_FailOffset");
+    ASSERT_EQ(24999, ids[24999], "PAR06_LastGood");
+
+    ASSERT_EQ(100, my_scanf_parallel("%d %lf", text, len, 100, cols, strides, 4, &fail), "PAR07_Cap");
+    ASSERT_EQ(99, ids[99], "PAR08_CapVal");
+    free(text); free(ids); free(vals);
+}
+
+void test_parallel_small_and_blank(void) {
+    // Test: Small input (one worker), blank lines, and two records on a line.
+    const char *text = "1 a\n\n   \n2 b\n";
+    const char *multi = "1 a 2 b\n";
+    int ids[4] = {0};
+    char names[4][4];
+    void *cols[] = {ids, names};
+    size_t strides[] = {sizeof(int), sizeof names[0]};
+    size_t fail = 0;
+
+    ASSERT_EQ(2, my_scanf_parallel("%d %3s", text, strlen(text), 4, cols, strides, 8, &fail), "PAR09_Rows");
+    ASSERT_EQ(2, ids[1], "PAR10_Val");
+    ASSERT_STREQ("b", names[1], "PAR11_Str");
+    ASSERT_EQ(strlen(text), fail, "PAR12_End");
+    ASSERT_EQ(1, my_scanf_parallel("%d %3s", multi, strlen(multi), 4, cols, strides, 0, &fail), "PAR13_Multi");
+    ASSERT_EQ(3, fail, "PAR14_MultiOffset");
+}
+
+void test_parallel_skewed_stats(void) {
+    // Test: A few very long lines among short ones; order holds, stats add up.
+    int n = 20000, bad = 0;
+    char *text = malloc((size_t)n * 16 + 4 * 200000);
+    int *ids = malloc(n * sizeof(int));
+    void *cols[] = {ids};
+    size_t strides[] = {sizeof(int)};
+    size_t len = 0, fail = 0;
+    unsigned long done = 0;
+    ParallelStats ps;
+
+    for (int i = 0; i < n; i++) {
+        if (i % 5000 == 0) {  // Long record: padding the units must absorb
+            memset(text + len, ' ', 200000);
+            len += 200000;
+        }
+        len += sprintf(text + len, "%d\n", i);
+    }
+
+    ASSERT_EQ(n, my_scanf_parallel("%d", text, len, n, cols, strides, 4, &fail), "PAR15_Rows");
+    ASSERT_EQ(len - 1, fail, "PAR16_End");
+    for (int i = 0; i < n; i++) bad |= (ids[i] != i);
+    ASSERT_EQ(0, bad, "PAR17_Order");
+
+    my_scanf_get_parallel_stats(&ps);
+    ASSERT_EQ(4, ps.workers, "PAR18_Workers");
+    for (int i = 0; i < ps.workers; i++) done += ps.units_done[i];
+    ASSERT_EQ(2 * ps.units, done, "PAR19_UnitsBothPasses");
+    ASSERT_EQ(1, ps.units > (size_t)ps.workers, "PAR20_FinerThanWorkers");
+    free(text); free(ids);
+}
+
+void test_parallel_batch_semantics(void) {
+    // Test: A failing line early on leaves the rows past the count as they
+    // were, and every stop offset is the one my_scanf_batch() reports.
+    int n = 20000, touched = 0;
+    char *text = malloc((size_t)n * 8);
+    int *ids = malloc(n * sizeof(int));
+    void *cols[] = {ids};
+    size_t strides[] = {sizeof(int)};
+    size_t len = 0, fail = 0, batch_fail = 0;
+    ScanSource src;
+
+    for (int i = 0; i < n; i++) len += sprintf(text + len, "%d\n", i);
+
+    // Clean input, n_max reached exactly and not reached
+    my_scanf_source_memory(&src, text, len);
+    my_scanf_batch("%d", &src, n, cols, strides, &batch_fail);
+    ASSERT_EQ(n, my_scanf_parallel("%d", text, len, n, cols, strides, 4, &fail), "PAR26_Rows");
+    ASSERT_EQ(batch_fail, fail, "PAR27_StopAtCap");
+    my_scanf_source_memory(&src, text, len);
+    my_scanf_batch("%d", &src, n + 5, cols, strides, &batch_fail);
+    ASSERT_EQ(n, my_scanf_parallel("%d", text, len, n + 5, cols, strides, 4, &fail), "PAR28_Rows");
+    ASSERT_EQ(batch_fail, fail, "PAR29_StopAtEnd");
+
+    // Bad line at row 2000: later units must not write their rows
+    strstr(text, "\n2000\n")[1] = 'X';
+    for (int i = 0; i < n; i++) ids[i] = -7;
+    my_scanf_source_memory(&src, text, len);
+    my_scanf_batch("%d", &src, n, cols, strides, &batch_fail);
+    for (int i = 0; i < n; i++) ids[i] = -7;
+    ASSERT_EQ(2000, my_scanf_parallel("%d", text, len, n, cols, strides, 4, &fail), "PAR30_Rows");
+    ASSERT_EQ(batch_fail, fail, "PAR31_FailOffset");
+    ASSERT_EQ(1999, ids[1999], "PAR32_LastGood");
+    for (int i = 2001; i < n; i++) touched += (ids[i] != -7);
+    ASSERT_EQ(0, touched, "PAR33_RowsPastCountKept");
+
+    // Struct rows with an unbounded %s, in an array of exactly n records
+    typedef struct { char pad; char name[7]; int id; } Rec;
+    Rec *recs = malloc(n * sizeof(Rec));
+    void *rec_cols[] = {&recs[0].id, recs[0].name};
+    size_t rec_strides[] = {sizeof(Rec), sizeof(Rec)};
+    len = 0;
+    for (int i = 0; i < n; i++) len += sprintf(text + len, "%d r%d\n", i % 1000, i % 10);
+    strstr(text, "\n500 r0\n")[1] = 'X';
+    memset(recs, 0x5a, n * sizeof(Rec));
+    ASSERT_EQ(500, my_scanf_parallel("%d %s", text, len, n, rec_cols, rec_strides, 4, &fail), "PAR34_StructRows");
+    ASSERT_STREQ("r9", recs[499].name, "PAR35_StructLastGood");
+    touched = 0;
+    for (int i = 501; i < n; i++) touched += (recs[i].pad != 0x5a || recs[i].id != 0x5a5a5a5a);
+    ASSERT_EQ(0, touched, "PAR36_StructRowsKept");
+    free(recs);
+    free(text); free(ids);
+}
+
+void test_parallel_worker_stats(void) {
+    // Test: Workers take the caller's %D cache setting, and their counters
+    // come back into the caller's stats.
+    int n = 30000;
+    char *text = malloc((size_t)n * 24);
+    int *ids = malloc(n * sizeof(int));
+    Date *dates = malloc(n * sizeof(Date));
+    void *cols[] = {ids, dates};
+    size_t strides[] = {sizeof(int), sizeof(Date)};
+    size_t len = 0, fail = 0;
+    ScanStats st;
+
+    for (int i = 0; i < n; i++) len += sprintf(text + len, "%d 0%d/03/2024\n", i, 1 + i / 10000);
+
+    my_scanf_date_cache(1);
+    my_scanf_reset_stats();
+    ASSERT_EQ(n, my_scanf_parallel("%d %D", text, len, n, cols, strides, 4, &fail), "PAR21_Rows");
+    my_scanf_get_stats(&st);
+    ASSERT_EQ(n, st.date_cache_hits + st.date_cache_misses, "PAR22_CacheSeenByAll");
+    ASSERT_EQ(1, st.date_cache_hits > st.date_cache_misses, "PAR23_WorkersHit");
+    ASSERT_EQ(n, st.index_fast_records + st.index_slow_records, "PAR24_IndexCounts");
+    ASSERT_EQ(3, dates[n - 1].day, "PAR25_Value");
+    my_scanf_date_cache(0);
+    free(text); free(ids); free(dates);
+}
+
 /* =========================================================================
  * MAIN RUNNER
  * ========================================================================= */
@@ -1958,6 +4503,21 @@ int main(void) {
     test_modifiers_lld();
     test_modifiers_hd();
 
+    test_i_auto_bases();
+    test_i_signs_and_zero();
+    test_i_octal_stops_at_8();
+    test_i_length_modifier();
+    test_u_basic();
+    test_u_width_and_negative();
+    test_o_basic();
+    test_o_modifiers();
+    test_radix_long_runs();
+    test_radix_width_stopper_kept();
+    test_i128_decimal();
+    test_i128_hex();
+    test_i128_wrap_and_width();
+    test_i128_suppress_octal();
+
     test_c_basic_letter();
     test_c_basic_digit();
     test_c_basic_symbol();
@@ -2062,6 +4622,11 @@ int main(void) {
     test_f_suppression();
     test_f_ignore_l_modifier();
     test_f_valid_dot_exponent();
+    test_a_hex_basic();
+    test_a_hex_exact_extremes();
+    test_a_hex_rounding();
+    test_a_hex_width_and_rollback();
+    test_e_g_specifiers();
 
     test_b_basic_zero();
     test_b_basic_one();
@@ -2130,6 +4695,41 @@ int main(void) {
     test_D_padded_year();
     test_D_format_space();
     test_D_complex_suppress();
+    test_D_fast_long_year_fallback();
+    test_D_fast_width_ten();
+    test_D_fast_variable_width_fallback();
+    test_D_fast_invalid_calendar();
+    test_D_fast_short_input();
+    test_D_fast_many_records();
+    test_D_cache_hits();
+    test_D_cache_keeps_stopper();
+    test_D_cache_invalid_not_cached();
+    test_D_cache_disabled_no_stats();
+    test_D_days_epoch();
+    test_D_days_leap_and_modern();
+    test_D_days_before_epoch();
+    test_D_days_invalid();
+    test_D_days_suppressed();
+    test_D_open_pipe_short_date();
+    test_D_stopper_not_buffered();
+
+    test_T_basic_utc_fraction();
+    test_T_epoch();
+    test_T_no_zone_is_utc();
+    test_T_offsets();
+    test_T_nanoseconds();
+    test_T_before_epoch();
+    test_T_invalid_calendar();
+    test_T_invalid_time();
+    test_T_bad_layout();
+    test_T_stopper_left();
+    test_T_lone_dot_stopper();
+    test_T_width();
+    test_T_suppressed();
+    test_T_int64_limits();
+    test_T_out_of_range_untouched();
+    test_T_open_pipe();
+    test_T_small_stream_buffer();
 
     test_R_basic();
     test_R_lowercase();
@@ -2153,6 +4753,115 @@ int main(void) {
     test_R_space_after_hash();
     test_R_literal_match_prefix();
     test_R_suppress_complex();
+    test_R_packed_rrggbb();
+    test_R_packed_rrggbbaa();
+    test_R_packed_short_forms();
+    test_R_packed_odd_length();
+    test_R_packed_too_short();
+    test_R_packed_width();
+    test_R_packed_missing_hash();
+    test_R_packed_suppressed();
+
+    test_N_ipv4_basic();
+    test_N_ipv4_port_stopper();
+    test_N_ipv4_invalid();
+    test_N_ipv4_width();
+    test_N_ipv6_full();
+    test_N_ipv6_compressed();
+    test_N_ipv6_embedded_ipv4();
+    test_N_ipv6_invalid();
+    test_N_ipv6_stopper();
+    test_N_suppressed();
+    test_N_memory_window();
+    test_N_memory_invalid();
+    test_N_block_boundaries();
+
+    test_U_basic();
+    test_U_uppercase_mixed();
+    test_U_bad_dash_rollback();
+    test_U_bad_hex();
+    test_U_too_short();
+    test_U_width();
+    test_U_flow_and_suppress();
+    test_U_open_pipe_short();
+    test_U_small_stream_buffer();
+
+    test_B_padded();
+    test_B_unpadded_full();
+    test_B_missing_padding();
+    test_B_binary_bytes();
+    test_B_long_payload();
+    test_B_stopper_left();
+    test_B_invalid();
+    test_B_width();
+    test_B_suppressed();
+    test_B_memory_chunks();
+    test_B_memory_stops();
+    test_B_memory_suppressed();
+    test_B_block_boundaries();
+    test_Z_small();
+    test_Z_sign_and_zero();
+    test_Z_large_powers();
+    test_Z_capacity_width_suppress();
+
+    test_set_basic_range();
+    test_set_negated();
+    test_set_csv_fields();
+    test_set_key_value();
+    test_set_no_whitespace_skip();
+    test_set_empty_match_fail();
+    test_set_width();
+    test_set_bracket_member();
+    test_set_literal_dash();
+    test_set_suppressed();
+    test_set_eof_fail();
+    test_set_memory_runs();
+    test_set_memory_many_ranges();
+    test_set_cached_directive();
+    test_set_block_boundaries();
+
+    test_bulk_rgb_basic();
+    test_bulk_rgba_alpha();
+    test_bulk_fail_offset();
+    test_bulk_bad_terminator();
+    test_bulk_max_colors();
+    test_bulk_unterminated_tail();
+    test_n_basic();
+    test_n_modifiers();
+    test_source_memory_tell();
+    test_source_memory_unterminated();
+    test_source_file_and_back();
+    test_source_pipelined();
+    test_source_pipelined_early_close();
+    test_source_pipelined_waits();
+    test_source_uring();
+    test_source_uring_batch();
+    test_source_uring_enter_fails();
+    test_source_fd();
+    test_source_fd_pipe_size();
+    test_batch_columns();
+    test_batch_failure_offset();
+    test_batch_strided_and_limit();
+    test_batch_stdin();
+    test_validate_counts();
+    test_validate_truncated_and_batch();
+    test_records_basic();
+    test_records_many();
+    test_records_invalid_schema();
+    test_records_field_ops();
+    test_indexed_columns();
+    test_indexed_literals();
+    test_indexed_fallback();
+    test_indexed_windows();
+    test_lazy_on_demand();
+    test_lazy_literals_and_errors();
+    test_lazy_strings();
+    test_parallel_order();
+    test_parallel_failure_and_cap();
+    test_parallel_small_and_blank();
+    test_parallel_skewed_stats();
+    test_parallel_worker_stats();
+    test_parallel_batch_semantics();
 
     printf("\n========================================\n");
     printf("TESTS RUN: %d\n", tests_run);